@@ -0,0 +1,278 @@
+/**
+ * \file		accumulate.c
+ * \brief       Accumulation of the matrix N and the vector u over a span of points
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Adds the contribution of a span of points to the upper triangular
+ * 					matrix N, the vector u and the sum of the weighted squared misclosures.
+ * 					With a robust weight function, the weight of every point is multiplied
+ * 					by the factor of its standardized misclosure (function robust_weight())
+ * \param[in]       sp: The span of points (Cartesian coordinates and weights)
+ * \param[in]       md: The coefficients of the linearized model
+ * \param[in,out]   matr: The structure <group> which accumulates the contribution
+ */
+void accumulate(struct span *sp, struct model *md, struct group *matr)
+{
+	register long k;
+	long n = sp->n, s = sp->stride;
+	double *x = sp->x, *y = sp->y, *z = sp->z, *w = sp->w;
+	type xi, yi, zi, pi, tx, ty, tz;
+	type pxx, pyy, pzz, pxy, pxz, pyz;
+	type dpxx_dax, dpxx_day, dpxx_daz, dpxx_dthy, dpxx_dthz;
+	type dpyy_dax, dpyy_day, dpyy_daz, dpyy_dthy, dpyy_dthz;
+	type dpzz_dax, dpzz_day, dpzz_daz, dpzz_dthy, dpzz_dthz;
+	type dpxy_dax, dpxy_day, dpxy_daz, dpxy_dthy, dpxy_dthz;
+	type dpxz_dax, dpxz_day, dpxz_daz, dpxz_dthy, dpxz_dthz;
+	type dpyz_dax, dpyz_day, dpyz_daz, dpyz_dthy, dpyz_dthz;
+	type dFi_dtx, dFi_dty, dFi_dtz, dFi_dax, dFi_day, dFi_daz, dFi_dthx, dFi_dthy, dFi_dthz;
+	type Fi, DX, DY, DZ, wi, DX2, DY2, DZ2, DXDY, DXDZ, DYDZ;
+	type p_bari, Wi, sum_piwi2, rho, weight;
+	type NC1, NC2, NC3, NC4, NC5, NC6, NC7, NC8;
+	type N00, N01, N02, N03, N04, N05, N06, N07, N08, U0;
+	type N11, N12, N13, N14, N15, N16, N17, N18, U1; 
+	type N22, N23, N24, N25, N26, N27, N28, U2;
+	type N33, N34, N35, N36, N37, N38, U3;
+	type N44, N45, N46, N47, N48 ,U4;
+	type N55, N56, N57, N58, U5;
+	type N66, N67, N68, U6;
+	type N77, N78, U7;
+	type N88, U8;
+
+	/* Initializing the partial sums of the matrix N and vector u */
+	N00 = N01 = N02 = N03 = N04 = N05 = N06 = N07 = N08 = U0 = N88 = U8 = 0.0L;
+	N11 = N12 = N13 = N14 = N15 = N16 = N17 = N18 = U1 = N77 = N78 = U7 = 0.0L;
+	N22 = N23 = N24 = N25 = N26 = N27 = N28 = U2 = N66 = N67 = N68 = U6 = 0.0L;
+	N33 = N34 = N35 = N36 = N37 = N38 = U3 = N55 = N56 = N57 = N58 = U5 = 0.0L;
+	N44 = N45 = N46 = N47 = N48 = U4 = sum_piwi2 = weight = 0.0L;
+	/* Copying the coefficients of the model into local variables */
+	tx = md->tx;
+	ty = md->ty;
+	tz = md->tz;
+	pxx = md->pxx;
+	pyy = md->pyy;
+	pzz = md->pzz;
+	pxy = md->pxy;
+	pxz = md->pxz;
+	pyz = md->pyz;
+	dpxx_dax = md->dpxx_dax;
+	dpyy_dax = md->dpyy_dax;
+	dpzz_dax = md->dpzz_dax;
+	dpxy_dax = md->dpxy_dax;
+	dpxz_dax = md->dpxz_dax;
+	dpyz_dax = md->dpyz_dax;
+	dpxx_day = md->dpxx_day;
+	dpyy_day = md->dpyy_day;
+	dpzz_day = md->dpzz_day;
+	dpxy_day = md->dpxy_day;
+	dpxz_day = md->dpxz_day;
+	dpyz_day = md->dpyz_day;
+	dpxx_daz = md->dpxx_daz;
+	dpyy_daz = md->dpyy_daz;
+	dpzz_daz = md->dpzz_daz;
+	dpxy_daz = md->dpxy_daz;
+	dpxz_daz = md->dpxz_daz;
+	dpyz_daz = md->dpyz_daz;
+	dpxx_dthy = md->dpxx_dthy;
+	dpyy_dthy = md->dpyy_dthy;
+	dpzz_dthy = md->dpzz_dthy;
+	dpxy_dthy = md->dpxy_dthy;
+	dpxz_dthy = md->dpxz_dthy;
+	dpyz_dthy = md->dpyz_dthy;
+	dpxx_dthz = md->dpxx_dthz;
+	dpyy_dthz = md->dpyy_dthz;
+	dpzz_dthz = md->dpzz_dthz;
+	dpxy_dthz = md->dpxy_dthz;
+	dpxz_dthz = md->dpxz_dthz;
+	dpyz_dthz = md->dpyz_dthz;
+	/* Calculating the elements of the N and u matrices for every point of the span */
+	for (k = 0; k < n; k++)
+	{
+		xi = x[k * s];
+		yi = y[k * s];
+		zi = z[k * s];
+		pi = w[k * s];
+		DX = xi - tx;
+		DY = yi - ty;
+		DZ = zi - tz;
+		DX2 = DX * DX;
+		DY2 = DY * DY;
+		DZ2 = DZ * DZ;
+		DXDY = DX * DY;
+		DXDZ = DX * DZ;
+		DYDZ = DY * DZ;
+		/* Calculating the partial derivatives of the function F with respect to tx, ty and tz */
+		dFi_dtx = -2.0L * pxx * DX -2.0L * pxy * DY -2.0L * pxz * DZ;
+		dFi_dty = -2.0L * pxy * DX -2.0L * pyy * DY -2.0L * pyz * DZ;
+		dFi_dtz = -2.0L * pxz * DX -2.0L * pyz * DY -2.0L * pzz * DZ;
+		/* Calculating the partial derivatives of the function F with respect to ax, ay and az */
+		dFi_dax = dpxx_dax * DX2 + dpyy_dax * DY2 + dpzz_dax * DZ2 + 2 * dpxy_dax * DXDY + 2 * dpxz_dax * DXDZ + 2 * dpyz_dax * DYDZ;
+		dFi_day = dpxx_day * DX2 + dpyy_day * DY2 + dpzz_day * DZ2 + 2 * dpxy_day * DXDY + 2 * dpxz_day * DXDZ + 2 * dpyz_day * DYDZ;
+		dFi_daz = dpxx_daz * DX2 + dpyy_daz * DY2 + dpzz_daz * DZ2 + 2 * dpxy_daz * DXDY + 2 * dpxz_daz * DXDZ + 2 * dpyz_daz * DYDZ;
+		/* Calculating the partial derivatives of the function F with respect to thetax, thetay and thetaz */
+		dFi_dthx = -2.0L * pyz * DY2 + 2.0L * pyz * DZ2 - 2.0L * pxz * DXDY + 2 * pxy * DXDZ + 2.0L * pyy * DYDZ - 2.0L * pzz * DYDZ;
+		dFi_dthy = dpxx_dthy * DX2 + dpyy_dthy * DY2 + dpzz_dthy * DZ2 + 2 * dpxy_dthy * DXDY + 2 * dpxz_dthy * DXDZ + 2 * dpyz_dthy * DYDZ;
+		dFi_dthz = dpxx_dthz * DX2 + dpyy_dthz * DY2 + dpzz_dthz * DZ2 + 2 * dpxy_dthz * DXDY + 2 * dpxz_dthz * DXDZ + 2 * dpyz_dthz * DYDZ;
+		wi = dFi_dtx * dFi_dtx + dFi_dty * dFi_dty + dFi_dtz * dFi_dtz;
+		wi /= pi;
+		p_bari = 1.0L / wi;
+		/* Calculating the function F(tx, ty, tz, ax, ay, az, thetax, thetay, thetaz) */
+		Fi = pxx * DX2 + pyy * DY2 + pzz * DZ2 + 2 * pxy * DXDY + 2 * pxz * DXDZ + 2 * pyz * DYDZ - 1.0L;
+		wi = -Fi;
+		/* Down-weighting the point according to its standardized misclosure */
+		if (md->robust != ROBUST_NONE)
+		{
+			rho = robust_weight(Fi * Fi * p_bari * md->iscale2, md);
+			p_bari *= rho;
+			weight += rho;
+		}
+		else
+			weight += 1.0L;
+		Wi = wi * p_bari;
+		sum_piwi2 += wi * Wi;
+		NC1 = dFi_dtx * p_bari;
+		NC2 = dFi_dty * p_bari;
+		NC3 = dFi_dtz * p_bari;
+		NC4 = dFi_dax * p_bari;
+		NC5 = dFi_day * p_bari;
+		NC6 = dFi_daz * p_bari;
+		NC7 = dFi_dthx * p_bari;
+		NC8 = dFi_dthy * p_bari;
+		/* Calculating each element of the matrix N */
+		N00 += NC1 * dFi_dtx;
+		N01 += NC1 * dFi_dty;
+		N02 += NC1 * dFi_dtz;
+		N03 += NC1 * dFi_dax;
+		N04 += NC1 * dFi_day;
+		N05 += NC1 * dFi_daz;
+		N06 += NC1 * dFi_dthx;
+		N07 += NC1 * dFi_dthy;
+		N08 += NC1 * dFi_dthz;
+		N11 += NC2 * dFi_dty;
+		N12 += NC2 * dFi_dtz;
+		N13 += NC2 * dFi_dax;
+		N14 += NC2 * dFi_day;
+		N15 += NC2 * dFi_daz;
+		N16 += NC2 * dFi_dthx;
+		N17 += NC2 * dFi_dthy;
+		N18 += NC2 * dFi_dthz;
+		N22 += NC3 * dFi_dtz;
+		N23 += NC3 * dFi_dax;
+		N24 += NC3 * dFi_day;
+		N25 += NC3 * dFi_daz;
+		N26 += NC3 * dFi_dthx;
+		N27 += NC3 * dFi_dthy;
+		N28 += NC3 * dFi_dthz;
+		N33 += NC4 * dFi_dax;
+		N34 += NC4 * dFi_day;
+		N35 += NC4 * dFi_daz;
+		N36 += NC4 * dFi_dthx;
+		N37 += NC4 * dFi_dthy;
+		N38 += NC4 * dFi_dthz;
+		N44 += NC5 * dFi_day;
+		N45 += NC5 * dFi_daz;
+		N46 += NC5 * dFi_dthx;
+		N47 += NC5 * dFi_dthy;
+		N48 += NC5 * dFi_dthz;
+		N55 += NC6 * dFi_daz;
+		N56 += NC6 * dFi_dthx;
+		N57 += NC6 * dFi_dthy;
+		N58 += NC6 * dFi_dthz;
+		N66 += NC7 * dFi_dthx;
+		N67 += NC7 * dFi_dthy;
+		N68 += NC7 * dFi_dthz;
+		N77 += NC8 * dFi_dthy;
+		N78 += NC8 * dFi_dthz;
+		N88 += dFi_dthz * dFi_dthz * p_bari;
+		/* Calculating each element of the vector u */
+		U0 += dFi_dtx * Wi;
+		U1 += dFi_dty * Wi;
+		U2 += dFi_dtz * Wi;
+		U3 += dFi_dax * Wi;
+		U4 += dFi_day * Wi;
+		U5 += dFi_daz * Wi;
+		U6 += dFi_dthx * Wi;
+		U7 += dFi_dthy * Wi;
+		U8 += dFi_dthz * Wi;
+	}
+	/* Adding the partial sums to the structure <group> */
+	matr->N_bar[0] += N00;
+	matr->N_bar[1] += N01;
+	matr->N_bar[2] += N02;
+	matr->N_bar[3] += N03;
+	matr->N_bar[4] += N04;
+	matr->N_bar[5] += N05;
+	matr->N_bar[6] += N06;
+	matr->N_bar[7] += N07;
+	matr->N_bar[8] += N08;
+	matr->N_bar[9] += N11;
+	matr->N_bar[10] += N12;
+	matr->N_bar[11] += N13;
+	matr->N_bar[12] += N14;
+	matr->N_bar[13] += N15;
+	matr->N_bar[14] += N16;
+	matr->N_bar[15] += N17;
+	matr->N_bar[16] += N18;
+	matr->N_bar[17] += N22;
+	matr->N_bar[18] += N23;
+	matr->N_bar[19] += N24;
+	matr->N_bar[20] += N25;
+	matr->N_bar[21] += N26;
+	matr->N_bar[22] += N27;
+	matr->N_bar[23] += N28;
+	matr->N_bar[24] += N33;
+	matr->N_bar[25] += N34;
+	matr->N_bar[26] += N35;
+	matr->N_bar[27] += N36;
+	matr->N_bar[28] += N37;
+	matr->N_bar[29] += N38;
+	matr->N_bar[30] += N44;
+	matr->N_bar[31] += N45;
+	matr->N_bar[32] += N46;
+	matr->N_bar[33] += N47;
+	matr->N_bar[34] += N48;
+	matr->N_bar[35] += N55;
+	matr->N_bar[36] += N56;
+	matr->N_bar[37] += N57;
+	matr->N_bar[38] += N58;
+	matr->N_bar[39] += N66;
+	matr->N_bar[40] += N67;
+	matr->N_bar[41] += N68;
+	matr->N_bar[42] += N77;
+	matr->N_bar[43] += N78;
+	matr->N_bar[44] += N88;
+	matr->U_bar[0] += U0;
+	matr->U_bar[1] += U1;
+	matr->U_bar[2] += U2;
+	matr->U_bar[3] += U3;
+	matr->U_bar[4] += U4;
+	matr->U_bar[5] += U5;
+	matr->U_bar[6] += U6;
+	matr->U_bar[7] += U7;
+	matr->U_bar[8] += U8;
+	matr->sum_piwi2 += sum_piwi2;
+	matr->weight += weight;
+	matr->c += n;
+}
@@ -0,0 +1,171 @@
+/**
+ * \file		accumulate_simd.c
+ * \brief       Double precision vector kernel with run-time selection of the instruction set
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+typedef double v8d __attribute__ ((vector_size (64)));
+typedef double v4d __attribute__ ((vector_size (32)));
+typedef double v2d __attribute__ ((vector_size (16)));
+
+#define KERNEL kernel_avx512
+#define VEC v8d
+#define LANES 8
+#define TARGET __attribute__ ((target ("avx512f")))
+#include "simd_kernel.h"
+#define PACKED packed_avx512
+#include "simd_packed.h"
+#undef PACKED
+#undef KERNEL
+#undef VEC
+#undef LANES
+#undef TARGET
+
+#define KERNEL kernel_avx2
+#define VEC v4d
+#define LANES 4
+#define TARGET __attribute__ ((target ("avx2,fma")))
+#include "simd_kernel.h"
+#define PACKED packed_avx2
+#include "simd_packed.h"
+#undef PACKED
+#undef KERNEL
+#undef VEC
+#undef LANES
+#undef TARGET
+
+#define KERNEL kernel_sse2
+#define VEC v2d
+#define LANES 2
+#define TARGET __attribute__ ((target ("sse2")))
+#include "simd_kernel.h"
+#define PACKED packed_sse2
+#include "simd_packed.h"
+#undef PACKED
+#undef KERNEL
+#undef VEC
+#undef LANES
+#undef TARGET
+#else
+typedef double v2d __attribute__ ((vector_size (16)));
+
+#define KERNEL kernel_generic
+#define VEC v2d
+#define LANES 2
+#define TARGET
+#include "simd_kernel.h"
+#define PACKED packed_generic
+#include "simd_packed.h"
+#undef PACKED
+#undef KERNEL
+#undef VEC
+#undef LANES
+#undef TARGET
+#endif
+
+/* The kernel of the processor, selected once by the function choose() */
+static void (*best)(struct span *, struct model *, struct group *);
+static void (*best_packed)(struct span *, struct model *, struct group *, int);
+static int best_lanes;
+static const char *best_name;
+static pthread_once_t chosen = PTHREAD_ONCE_INIT;
+
+/**
+ * \brief           Selects the widest instruction set which is supported by the processor
+ */
+static void choose(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+	{
+		best = kernel_avx512;
+		best_packed = packed_avx512;
+		best_lanes = 8;
+		best_name = "AVX-512";
+	}
+	else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+	{
+		best = kernel_avx2;
+		best_packed = packed_avx2;
+		best_lanes = 4;
+		best_name = "AVX2";
+	}
+	else
+	{
+		best = kernel_sse2;
+		best_packed = packed_sse2;
+		best_lanes = 2;
+		best_name = "SSE2";
+	}
+#else
+	best = kernel_generic;
+	best_packed = packed_generic;
+	best_lanes = 2;
+	best_name = "generic";
+#endif
+}
+
+/**
+ * \brief           Adds the contribution of a span of points to the upper triangular
+ * 					matrix N, the vector u and the sum of the weighted squared misclosures
+ * 					in double precision, with the vector kernel of the processor
+ * \param[in]       sp: The span of points (Cartesian coordinates and weights)
+ * \param[in]       md: The coefficients of the linearized model
+ * \param[in,out]   matr: The structure <group> which accumulates the contribution
+ */
+void accumulate_simd(struct span *sp, struct model *md, struct group *matr)
+{
+	pthread_once(&chosen, choose);
+	best(sp, md, matr);
+}
+
+/**
+ * \brief           Adds the contribution of k independent spans of points, each with its own
+ * 					linearized model, to their structures <group> in double precision. The fits
+ * 					are packed into the lanes of the vector kernel of the processor
+ * \param[in]       sp: Vector of the k spans of points (at least one point each)
+ * \param[in]       md: Vector of the k coefficients of the linearized models
+ * \param[in,out]   matr: Vector of the k structures <group> which accumulate the contributions
+ * \param[in]       k: The number of fits
+ */
+void accumulate_packed(struct span *sp, struct model *md, struct group *matr, int k)
+{
+	register int i;
+
+	pthread_once(&chosen, choose);
+	for (i = 0; i < k; i += best_lanes)
+		best_packed(&sp[i], &md[i], &matr[i], k - i < best_lanes ? k - i : best_lanes);
+}
+
+/**
+ * \brief           Gives the name of the instruction set of the vector kernel
+ * \return			The name of the instruction set
+ */
+const char *simd_name(void)
+{
+	pthread_once(&chosen, choose);
+	return best_name;
+}
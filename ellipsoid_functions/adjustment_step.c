@@ -0,0 +1,79 @@
+/**
+ * \file		adjustment_step.c
+ * \brief       An iteration of the least-squares adjustment
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Completes an iteration of the least-squares adjustment from the contribution
+ * 					(N, u) of all the points at the parameters of the state: solves the normal
+ * 					equations, calculates the a-posteriori standard deviation, whose redundancy
+ * 					is the sum of the weight factors minus 9, updates the scale of the Huber and
+ * 					Tukey weights, corrects the parameters with the step control of the options
+ * 					(function damped_step()) and tests the convergence (function has_converged())
+ * \param[in,out]   adj: The structure <adjustment> of the fit (members iteration zero and warm set
+ * 					before the first iteration), whose member g is the contribution at the parameters x
+ * \param[in,out]   opt: The run-time options (step control, tolerances, iterations, weight
+ * 					function and instrumentation), which receive the scale of the robust weights
+ * \return			Zero to continue, one after the last iteration (converged or the maximum
+ * 					number of iterations), or -1 if the matrix N is not positive definite
+ */
+int adjustment_step(struct adjustment *adj, struct options *opt)
+{
+	type ds[9], uTds;
+	struct stage_timer tm;
+
+	/* The convergence is tested against the last accepted iteration. The first iteration is compared
+	 * with a second one, unless its initial values are the solution of a subsample: it is then tested
+	 * against the standard deviation at the initial values (with the Huber and Tukey weights against
+	 * the scale of the weights of the pass, which must settle as well), so that it can converge alone */
+	if (adj->iteration == 0)
+	{
+		if (!adj->warm)
+			adj->sigma0i = 2.0L;
+		else if (opt->robust == ROBUST_HUBER || opt->robust == ROBUST_TUKEY)
+			adj->sigma0i = opt->scale;
+		else
+			adj->sigma0i = sqrt(adj->g.sum_piwi2 / (adj->g.weight - 9));
+		adj->converged = false;
+		adj->dm.started = false;
+	}
+	else if (adj->accepted)
+		adj->sigma0i = adj->sigma0ip1;
+	stage_begin(opt->prof, &tm);
+	if (ldl_factor(&adj->g.N_bar[0], &adj->f) != 0)
+		return -1;
+	ldl_solve(&adj->f, &adj->g.U_bar[0], &ds[0]);
+	stage_end(opt->prof, PROF_SOLVE, &tm, 0);
+	multiply(&adj->g.U_bar[0], &ds[0], &uTds, 1, 9, 1);
+	adj->sigma0ip1 = sqrt((adj->g.sum_piwi2 - uTds) / (adj->g.weight - 9));
+	/* The scale of the robust weights of the next iteration (the mask keeps the scale of the RANSAC pre-fit) */
+	if (opt->robust == ROBUST_HUBER || opt->robust == ROBUST_TUKEY)
+		opt->scale = adj->sigma0ip1;
+	adj->accepted = damped_step(&adj->dm, &adj->g, &ds[0], &adj->x[0], &adj->step[0], opt);
+	adj->iteration++;
+	profile_iteration(opt->prof, 1, adj->iteration, adj->sigma0ip1, &adj->step[0]);
+	adj->converged = adj->accepted && has_converged(adj->sigma0i, adj->sigma0ip1, &adj->step[0], &adj->x[0], opt);
+	return (adj->converged || adj->iteration >= opt->iterations) ? 1 : 0;
+}
@@ -0,0 +1,171 @@
+/**
+ * \file		algebraic_fit.c
+ * \brief       Algebraic fitting of the ellipsoid
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Calculates the parameters of the triaxial ellipsoid from the
+ * 					moment sums of the points by solving the linear system of the
+ * 					algebraic (quadric) fitting
+ * \param[in]       mom: The structure <moments> which contains the sums a1, ..., a34
+ * \param[out]      values: Vector of the initial values of the triaxial ellipsoid
+ * \return			Zero, or -1 if the quadric is degenerate (e = 0)
+ */
+int algebraic_fit(struct moments *mom, type *values)
+{
+	register int i;
+	type N[NPACK], U[9], C[9];
+	struct ldl f;
+	type cxx, cyy, czz, cxy, cxz, cyz, cx, cy, cz, f1, f2, f3, g2, g3, h3, e;
+	type tx, ty, tz, ax, ay, az, theta_x, theta_y, theta_z, qxx, qxy, qxz, qyy, qyz, qzz, d;
+	type q1, q2, w, Q;
+	type A1, B1, C1, A2, B2, C2, A3, B3, C3, E1, E2, E3;
+	type a[35];
+	
+	/* Renaming the moment sums as a1, ..., a34 */
+	for (i = 0; i < 34; i++)
+		a[i + 1] = mom->a[i];
+	/* Designing the matrix N (packed, upper triangle by rows) */
+	N[0] = a[1];
+	N[1] = a[2];
+	N[2] = a[3];
+	N[3] = a[4];
+	N[4] = a[5];
+	N[5] = a[6];
+	N[6] = a[7];
+	N[7] = a[8];
+	N[8] = a[9];
+	N[9] = a[10];
+	N[10] = a[11];
+	N[11] = a[12];
+	N[12] = a[13];
+	N[13] = a[14];
+	N[14] = a[15];
+	N[15] = a[16];
+	N[16] = a[17];
+	N[17] = a[18];
+	N[18] = a[19];
+	N[19] = a[20];
+	N[20] = a[21];
+	N[21] = a[22];
+	N[22] = a[23];
+	N[23] = a[24];
+	N[24] = a[2];
+	N[25] = a[6];
+	N[26] = a[13];
+	N[27] = a[8];
+	N[28] = a[15];
+	N[29] = a[25];
+	N[30] = a[3];
+	N[31] = a[19];
+	N[32] = a[9];
+	N[33] = a[25];
+	N[34] = a[22];
+	N[35] = a[11];
+	N[36] = a[25];
+	N[37] = a[17];
+	N[38] = a[23];
+	N[39] = a[26];
+	N[40] = a[27];
+	N[41] = a[28];
+	N[42] = a[29];
+	N[43] = a[30];
+	N[44] = a[31];
+	/* Designing the vector u */
+	U[0] = a[26];
+	U[1] = a[29];
+	U[2] = a[31];
+	U[3] = a[27];
+	U[4] = a[28];
+	U[5] = a[30];
+	U[6] = a[32];
+	U[7] = a[33];
+	U[8] = a[34];
+	/* Solving N C = u by calling the functions ldl_factor() and ldl_solve() */
+	ldl_factor(&N[0], &f);
+	ldl_solve(&f, &U[0], &C[0]);
+	/* Calculation of the initial values of the triaxial ellipsoid */
+	cxx = C[0];
+	cyy = C[1];
+	czz = C[2];
+	cxy = C[3];
+	cxz = C[4];
+	cyz = C[5];
+	cx = C[6];
+	cy = C[7];
+	cz = C[8];
+	f1 = 4. * cyy * czz - cyz * cyz;
+	f2 = cxz * cyz - 2 * cxy * czz;
+	f3 = cxy * cyz - 2 * cxz * cyy;
+	g2 = 4. * cxx * czz - cxz * cxz;
+	g3 = cxy * cxz - 2 * cxx * cyz;
+	h3 = 4. * cxx * cyy - cxy * cxy;
+	e = 2. * cxx * f1 + cxy * f2 + cxz * f3;
+	if(e == 0.0L)
+		return -1;
+	tx = - (f1 * cx + f2 * cy + f3 * cz) / e;
+	ty = - (f2 * cx + g2 * cy + g3 * cz) / e;
+	tz = - (f3 * cx + g3 * cy + h3 * cz) / e;
+	d = 1.0L + cxx * tx * tx + cyy * ty * ty + czz * tz * tz + cxy * tx * ty + cxz * tx * tz + cyz * ty * tz;
+	qxx = 2.0L * d * f1 / e;
+	qxy = 2.0L * d * f2 / e;
+	qxz = 2.0L * d * f3 / e;
+	qyy = 2.0L * d * g2 / e;
+	qyz = 2.0L * d * g3 / e;
+	qzz = 2.0L * d * h3 / e;
+	q1 = 1.0L * (qxx + qyy + qzz) / 3.0L;
+	q2 = 1.0L * (qyy * qzz + qxx * qzz + qxx * qyy - qyz * qyz - qxz * qxz - qxy * qxy) / 3.0L;
+	Q = qxx * (qyy * qzz - qyz * qyz) + qxy * (qxz * qyz - qxy * qzz) + qxz * (qxy * qyz - qxz * qyy);
+	w = acos((Q + 2 * q1 * q1 * q1 - 3 * q1 * q2) / (2 * pow(q1 * q1 - q2, 1.5)));
+	ax = sqrt(q1 + 2 * sqrt(q1 * q1 - q2) * cos(w / 3));
+	ay = sqrt(q1 + 2 * sqrt(q1 * q1 - q2) * cos((w - 2 * M_PI) / 3));
+	az = sqrt(q1 + 2 * sqrt(q1 * q1 - q2) * cos((w + 2 * M_PI) / 3));
+	A1 = qxy * qxz - qyz * qxx + ax * ax * qyz;
+	B1 = qxy * qyz - qxz * qyy + ax * ax * qxz;
+	C1 = qxz * qyz - qxy * qzz + ax * ax * qxy;
+    	A2 = qxy * qxz - qyz * qxx + ay * ay * qyz;
+	B2 = qxy * qyz - qxz * qyy + ay * ay * qxz;		
+	C2 = qxz * qyz - qxy * qzz + ay * ay * qxy;
+	A3 = qxy * qxz - qyz * qxx + az * az * qyz;
+	B3 = qxy * qyz - qxz * qyy + az * az * qxz;
+	C3 = qxz * qyz - qxy * qzz + az * az * qxy;
+	E1 = sqrt(1.0L / A1 / A1 + 1.0L / B1 / B1 + 1.0L / C1 / C1);
+	E2 = sqrt(1.0L / A2 / A2 + 1.0L / B2 / B2 + 1.0L / C2 / C2);
+	E3 = sqrt(1.0L / A3 / A3 + 1.0L / B3 / B3 + 1.0L / C3 / C3);
+	theta_x = atan(-C3 / B3);
+	theta_y = atan((A1 * E1 * A2 * E2) / (A3 * E3 * sqrt(A1 * A1 * E1 * E1 + A2 * A2 * E2 * E2)));
+	theta_z = atan(-A1 * E1 / A2 / E2);
+	/* Vector of the initial values */
+	values[0] = tx;
+	values[1] = ty;
+	values[2] = tz;
+	values[3] = ax;
+	values[4] = ay;
+	values[5] = az;
+	values[6] = (theta_x < 0) ? -theta_x:theta_x;
+	values[7] = (theta_y < 0) ? -theta_y:theta_y;
+	values[8] = (theta_z < 0) ? -theta_z:theta_z;
+	return 0;
+}
@@ -0,0 +1,506 @@
+/**
+ * \file		batch_fit.c
+ * \brief       Fitting of many independent ellipsoids (batch mode)
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/* A structure for an object of the manifest: a range of points of a data file */
+struct object {
+	char id[BATCH_ID];
+	int file;
+	long first;
+	long count;
+};
+
+/* A structure for the shared state of the workers: the objects, the units of work
+ * (packs of objects, sorted by size) and the next unit to be taken */
+struct batch {
+	struct data_file *files;
+	struct object *obj;
+	int *order; /* Objects sorted by decreasing number of points */
+	long *unit; /* First position in order of every unit */
+	long units;
+	long next;
+	bool simd;
+	struct options *opt; /* The run-time options of the iterations (tolerances, iterations and step control) */
+	struct batch_record *rec;
+	pthread_mutex_t lock;
+};
+
+/**
+ * \brief           Loads the points of an object into memory
+ * \param[in]       df: The structure <data_file> of the data file of the object
+ * \param[in]       ob: The object
+ * \param[out]      sp: The span of the loaded points
+ * \return			The loaded points (to be freed), or a null pointer for a read error
+ */
+static struct cart_coord *load_object(struct data_file *df, struct object *ob, struct span *sp)
+{
+	long j, k, n;
+	struct cart_coord buf[BLOCK], *pts;
+	struct span part;
+
+	if ((pts = malloc(ob->count * sizeof(struct cart_coord))) == NULL)
+		return NULL;
+	for (k = 0; k < ob->count; k += n)
+	{
+		if ((n = fetch_points(df, ob->first + k, ob->count - k, buf, &part)) <= 0)
+		{
+			free(pts);
+			return NULL;
+		}
+		for (j = 0; j < n; j++)
+		{
+			pts[k + j].x = part.x[j * part.stride];
+			pts[k + j].y = part.y[j * part.stride];
+			pts[k + j].z = part.z[j * part.stride];
+			pts[k + j].w = part.w[j * part.stride];
+		}
+	}
+	sp->x = &pts[0].x;
+	sp->y = &pts[0].y;
+	sp->z = &pts[0].z;
+	sp->w = &pts[0].w;
+	sp->stride = 4;
+	sp->n = ob->count;
+	return pts;
+}
+
+/**
+ * \brief           Fits the objects of a unit together: the initial values from the moment sums
+ * 					and the iterative adjustment of every object (function adjustment_step()),
+ * 					until it converges. In every iteration the objects which have not converged
+ * 					are accumulated at once, packed into the lanes of the vector kernel
+ * \param[in,out]   bt: The shared state of the workers
+ * \param[in]       list: The indices of the k objects of the unit
+ * \param[in]       k: The number of objects (1 to BATCH_PACK)
+ */
+static void fit_unit(struct batch *bt, int *list, int k)
+{
+	register int i, j, l, q;
+	int na, rc, active[BATCH_PACK];
+	type Ninv[9][9];
+	struct cart_coord *pts[BATCH_PACK];
+	struct span sp[BATCH_PACK], spa[BATCH_PACK];
+	struct model md[BATCH_PACK];
+	struct group ga[BATCH_PACK];
+	struct adjustment adj[BATCH_PACK];
+	struct moments mom;
+	struct batch_record *rec;
+
+	/* Loading the points and calculating the initial values of every object */
+	for (l = 0, na = 0; l < k; l++)
+	{
+		rec = &bt->rec[list[l]];
+		rec->c = bt->obj[list[l]].count;
+		rec->iterations = 0;
+		pts[l] = NULL;
+		if (rec->c < 10)
+		{
+			rec->status = BATCH_FEW;
+			continue;
+		}
+		if ((pts[l] = load_object(&bt->files[bt->obj[list[l]].file], &bt->obj[list[l]], &sp[l])) == NULL)
+		{
+			rec->status = BATCH_READ;
+			continue;
+		}
+		mom.c = 0;
+		for (i = 0; i < 34; i++)
+			mom.a[i] = 0.0L;
+		moment_sums(&sp[l], &mom);
+		if (algebraic_fit(&mom, &adj[l].x[0]) != 0)
+		{
+			rec->status = BATCH_SINGULAR;
+			continue;
+		}
+		adj[l].iteration = 0;
+		adj[l].warm = false;
+		active[na++] = l;
+	}
+	/* Iterative adjustment procedure of the objects which have not converged */
+	while (na > 0)
+	{
+		for (j = 0; j < na; j++)
+		{
+			l = active[j];
+			model_coefficients(&adj[l].x[0], &md[j]);
+			md[j].kernel = bt->simd ? accumulate_simd : accumulate;
+			spa[j] = sp[l];
+			zeros(&ga[j].N_bar[0], NPACK, 1);
+			zeros(&ga[j].U_bar[0], 9, 1);
+			ga[j].sum_piwi2 = 0.0L;
+			ga[j].weight = 0.0L;
+			ga[j].c = 0;
+		}
+		if (bt->simd && na > 1)
+			accumulate_packed(spa, md, ga, na);
+		else
+			for (j = 0; j < na; j++)
+				md[j].kernel(&spa[j], &md[j], &ga[j]);
+		for (j = 0, i = 0; j < na; j++)
+		{
+			l = active[j];
+			rec = &bt->rec[list[l]];
+			adj[l].g = ga[j];
+			if ((rc = adjustment_step(&adj[l], bt->opt)) < 0)
+			{
+				rec->status = BATCH_SINGULAR;
+				continue;
+			}
+			if (rc == 0)
+			{
+				active[i++] = l;
+				continue;
+			}
+			/* The standard deviations from the diagonal of the inverse of the last normal matrix */
+			ldl_inverse(&adj[l].f, &Ninv[0][0], false);
+			if (!isfinite(adj[l].sigma0ip1))
+				rec->status = BATCH_SINGULAR;
+			else
+				rec->status = adj[l].converged ? BATCH_OK : BATCH_MAXITER;
+			rec->iterations = adj[l].iteration;
+			rec->s0 = adj[l].sigma0ip1;
+			for (q = 0; q < 9; q++)
+			{
+				rec->x[q] = adj[l].x[q] * (q < 6 ? 1.0L : RDEG);
+				rec->sx[q] = adj[l].sigma0ip1 * sqrt(Ninv[q][q]) * (q < 6 ? 1.0L : RDEG);
+			}
+		}
+		na = i;
+	}
+	for (l = 0; l < k; l++)
+		free(pts[l]);
+}
+
+/**
+ * \brief           Takes the units of work until all the objects are fitted
+ * \param[in]       arg: A pointer to the shared state <batch> of the workers
+ * \return			A null pointer
+ */
+static void *batch_worker(void *arg)
+{
+	struct batch *bt = arg;
+	long u;
+
+	for (;;)
+	{
+		pthread_mutex_lock(&bt->lock);
+		u = bt->next++;
+		pthread_mutex_unlock(&bt->lock);
+		if (u >= bt->units)
+			break;
+		fit_unit(bt, &bt->order[bt->unit[u]], bt->unit[u + 1] - bt->unit[u]);
+	}
+	return NULL;
+}
+
+/* The objects of the sorting of the function by_size() */
+static struct object *sorted;
+
+/**
+ * \brief           Compares two objects by their number of points (decreasing order)
+ * \param[in]       a: A pointer to the index of the first object
+ * \param[in]       b: A pointer to the index of the second object
+ * \return			Negative, zero or positive, as in the function qsort()
+ */
+static int by_size(const void *a, const void *b)
+{
+	long ca = sorted[*(const int *)a].count, cb = sorted[*(const int *)b].count;
+
+	return (ca < cb) - (ca > cb);
+}
+
+/**
+ * \brief           Reads the manifest of the objects. Every line contains the identifier of
+ * 					an object, the name of its data file and, optionally, the first point and
+ * 					the number of points of the object in the file (all the file by default).
+ * 					Empty lines and lines which start with # are ignored. Every data file is
+ * 					opened once
+ * \param[in]       name: The name of the manifest
+ * \param[in]       opt: The run-time options of the opening of the data files
+ * \param[out]      obj: The objects (to be freed)
+ * \param[out]      files: The opened data files (to be freed)
+ * \param[out]      nfiles: The number of the opened data files
+ * \return			The number of objects, or -1 for an error (which is printed)
+ */
+static long read_manifest(char *name, struct options *opt, struct object **obj, struct data_file **files, int *nfiles)
+{
+	FILE *fp;
+	char line[8192], id[BATCH_ID + 1], file[4096], **names = NULL;
+	long n = 0, size = 0, first, count, lineno = 0;
+	int i, fields, nf = 0;
+	void *more;
+
+	*obj = NULL;
+	*files = NULL;
+	if ((fp = fopen(name, "r")) == NULL)
+	{
+		printf("\nCant open the manifest %s", name);
+		return -1;
+	}
+	while (fgets(line, sizeof(line), fp) != NULL)
+	{
+		lineno++;
+		if ((fields = sscanf(line, "%64s %4095s %ld %ld", id, file, &first, &count)) <= 0 || id[0] == '#')
+			continue;
+		if ((fields != 2 && fields != 4) || strlen(id) >= BATCH_ID || (fields == 4 && (first < 0 || count < 1)))
+		{
+			printf("\nInvalid line %ld of the manifest %s", lineno, name);
+			goto fail;
+		}
+		/* Opening the data file, if it is not already opened (the last one is checked first) */
+		for (i = nf - 1; i >= 0 && strcmp(names[i], file) != 0; i--);
+		if (i < 0)
+		{
+			if ((more = realloc(*files, (nf + 1) * sizeof(struct data_file))) == NULL)
+				goto fail;
+			*files = more;
+			if ((more = realloc(names, (nf + 1) * sizeof(char *))) == NULL)
+				goto fail;
+			names = more;
+			if ((names[nf] = strdup(file)) == NULL)
+				goto fail;
+			if (open_data(names[nf], &(*files)[nf], opt) != 0)
+			{
+				printf("\n\tCant open the file %s", file);
+				free(names[nf]);
+				goto fail;
+			}
+			i = nf++;
+		}
+		if (fields == 2)
+		{
+			first = 0;
+			count = (*files)[i].c;
+		}
+		else if (first + count > (*files)[i].c)
+		{
+			printf("\nThe points of the line %ld of the manifest %s are beyond the end of the file %s", lineno, name, file);
+			goto fail;
+		}
+		if (n == size)
+		{
+			size = size > 0 ? 2 * size : 1024;
+			if ((more = realloc(*obj, size * sizeof(struct object))) == NULL)
+				goto fail;
+			*obj = more;
+		}
+		strcpy((*obj)[n].id, id);
+		(*obj)[n].file = i;
+		(*obj)[n].first = first;
+		(*obj)[n].count = count;
+		n++;
+	}
+	fclose(fp);
+	for (i = 0; i < nf; i++)
+		free(names[i]);
+	free(names);
+	*nfiles = nf;
+	return n;
+fail:
+	fclose(fp);
+	for (i = 0; i < nf; i++)
+	{
+		close_data(&(*files)[i]);
+		free(names[i]);
+	}
+	free(names);
+	free(*obj);
+	free(*files);
+	return -1;
+}
+
+/**
+ * \brief           Writes the output table, in CSV format if its name ends with .csv,
+ * 					otherwise in binary format (structures <batch_header> and <batch_record>)
+ * \param[in]       name: The name of the output table
+ * \param[in]       rec: The results of the objects, in the order of the manifest
+ * \param[in]       n: The number of objects
+ * \return			Zero, or -1 for an error
+ */
+static int write_table(char *name, struct batch_record *rec, long n)
+{
+	static const char *status[] = {"ok", "few", "singular", "read", "maxiter"};
+	static const char *par[] = {"tx", "ty", "tz", "ax", "ay", "az", "theta_x", "theta_y", "theta_z"};
+	FILE *fp;
+	size_t len = strlen(name);
+	struct batch_header hd;
+	register int j;
+	long i;
+	int rc;
+
+	if ((fp = fopen(name, "wb")) == NULL)
+		return -1;
+	if (len > 4 && strcmp(name + len - 4, ".csv") == 0)
+	{
+		fprintf(fp, "id,status,c,iterations,s0");
+		for (j = 0; j < 9; j++)
+			fprintf(fp, ",%s", par[j]);
+		for (j = 0; j < 9; j++)
+			fprintf(fp, ",s_%s", par[j]);
+		fprintf(fp, "\n");
+		for (i = 0; i < n; i++)
+		{
+			fprintf(fp, "%s,%s,%d,%d,%.10g", rec[i].id, status[rec[i].status], rec[i].c, rec[i].iterations, rec[i].s0);
+			for (j = 0; j < 9; j++)
+				fprintf(fp, ",%.10g", rec[i].x[j]);
+			for (j = 0; j < 9; j++)
+				fprintf(fp, ",%.10g", rec[i].sx[j]);
+			fprintf(fp, "\n");
+		}
+	}
+	else
+	{
+		memset(&hd, 0, sizeof(hd));
+		memcpy(hd.magic, BATCH_MAGIC, 8);
+		hd.version = BATCH_VERSION;
+		hd.record = sizeof(struct batch_record);
+		hd.objects = n;
+		fwrite(&hd, sizeof(hd), 1, fp);
+		fwrite(rec, sizeof(struct batch_record), n, fp);
+	}
+	rc = ferror(fp) ? -1 : 0;
+	return (fclose(fp) != 0 || rc != 0) ? -1 : 0;
+}
+
+/**
+ * \brief           Fits an independent triaxial ellipsoid to every object of a manifest,
+ * 					in one process: the objects are shared among a pool of threads, and the
+ * 					small objects are fitted together, packed into the lanes of the vector
+ * 					kernel (option -s). The results are written to one output table
+ * \param[in]       argc: The number of arguments that main was called (integer)
+ * \param[in]       argv: The vector of the arguments (string) which contains
+ * 					the options, the name of the manifest and the name of the output table
+ * \return			An integer value equal to zero
+ */
+int main(int argc, char *argv[])
+{
+	int first, nfiles = 0;
+	register int i;
+	long n, k, u, ok = 0, maxiter = 0;
+	struct options opt;
+	struct object *obj;
+	struct data_file *files;
+	struct batch bt;
+	struct rlimit rl;
+	struct timespec t0, t1;
+	double *arena = NULL;
+
+	/* Reading the options of the command line by calling the function options() */
+	if ((first = options(argc, argv, &opt)) < 0 || argc - first != 2)
+	{
+		printf("\nUsage: %s [-j threads] [-m] [-c MB] [-s] [-T tol] [-X tol] [-I iterations] [-L halving|lm] manifest output.csv|output.bin\n", argv[0]);
+		exit(1);
+	}
+	/* The objects of a unit share the options, so the scale of the robust weights cannot be kept per object */
+	if (opt.robust != ROBUST_NONE || opt.ransac > 0 || opt.coarse > 0.0)
+	{
+		printf("\nThe robust estimation (-r), the RANSAC pre-fit (-A) and the coarse iterations (-F) are not available in the batch fitting\n");
+		exit(1);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	/* Every data file of the manifest stays open, so the limit of the open files is raised */
+	if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max)
+	{
+		rl.rlim_cur = rl.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &rl);
+	}
+	if ((n = read_manifest(argv[first], &opt, &obj, &files, &nfiles)) < 0)
+		exit(1);
+	if (n == 0)
+	{
+		printf("\nThere are no objects in the manifest %s\n", argv[first]);
+		exit(1);
+	}
+	/* Loading the points into the cache by calling the function load_cache() */
+	if (opt.cache > 0)
+		arena = load_cache(files, nfiles, (size_t)opt.cache << 20);
+	bt.files = files;
+	bt.obj = obj;
+	bt.simd = opt.simd;
+	bt.opt = &opt;
+	bt.next = 0;
+	bt.order = malloc(n * sizeof(int));
+	bt.unit = malloc((n + 1) * sizeof(long));
+	bt.rec = calloc(n, sizeof(struct batch_record));
+	if (bt.order == NULL || bt.unit == NULL || bt.rec == NULL)
+	{
+		printf("\nNot enough memory for %ld objects", n);
+		exit(1);
+	}
+	for (k = 0; k < n; k++)
+	{
+		bt.order[k] = k;
+		strcpy(bt.rec[k].id, obj[k].id);
+	}
+	/* The large objects are fitted one by one and first, the small ones in packs of similar size */
+	sorted = obj;
+	qsort(bt.order, n, sizeof(int), by_size);
+	for (k = 0, u = 0; k < n; u++)
+	{
+		bt.unit[u] = k;
+		k += obj[bt.order[k]].count > BLOCK ? 1 : BATCH_PACK;
+		k = k < n ? k : n;
+	}
+	bt.unit[u] = n;
+	bt.units = u;
+	pthread_mutex_init(&bt.lock, NULL);
+	{
+		pthread_t tid[opt.threads];
+		bool started[opt.threads];
+
+		for (i = 0; i < opt.threads; i++)
+			started[i] = i > 0 && pthread_create(&tid[i], NULL, batch_worker, &bt) == 0;
+		/* The calling thread is the worker 0 */
+		batch_worker(&bt);
+		for (i = 1; i < opt.threads; i++)
+			if (started[i])
+				pthread_join(tid[i], NULL);
+	}
+	pthread_mutex_destroy(&bt.lock);
+	if (write_table(argv[first + 1], bt.rec, n) != 0)
+	{
+		printf("\nCant write the output table %s\n", argv[first + 1]);
+		exit(1);
+	}
+	for (k = 0; k < n; k++)
+	{
+		ok += bt.rec[k].status == BATCH_OK;
+		maxiter += bt.rec[k].status == BATCH_MAXITER;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	printf("\nObjects = %ld (%ld fitted, %ld not converged, %ld failed)\nFiles = %d", n, ok, maxiter, n - ok - maxiter, nfiles);
+	printf("\nExecution time = %.3f [s]\n", (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9);
+	/* Closing all the data files */
+	for (i = 0; i < nfiles; i++)
+		close_data(&files[i]);
+	free(arena);
+	free(files);
+	free(obj);
+	free(bt.order);
+	free(bt.unit);
+	free(bt.rec);
+	return 0;
+}
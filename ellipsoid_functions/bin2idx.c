@@ -0,0 +1,73 @@
+/**
+ * \file		bin2idx.c
+ * \brief       Creation of the index files of binary data files
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Reads binary data files once and writes their index files (name.idx),
+ * 					which keep the number of points, the bounding box, the sum of the
+ * 					weights and the moment sums of the initial values. The programs
+ * 					separation_in_groups and sequential_adjustments use the index
+ * 					instead of reading the points for the initial values
+ * \param[in]       argc: The number of arguments that main was called (integer)
+ * \param[in]       argv: The vector of arguments (string) which contains
+ * 					the options and the names of the data files
+ * \return			Zero on success, or one on failure
+ */
+int main(int argc, char *argv[])
+{
+	register int i;
+	int first;
+	struct data_file df;
+	struct point_index idx;
+	struct options opt;
+
+	if ((first = options(argc, argv, &opt)) < 0 || first == argc)
+	{
+		printf("\nUsage: %s [-m] file1.bin [file2.bin ...]\n", argv[0]);
+		exit(1);
+	}
+	for (i = first; i < argc; i++)
+	{
+		if (open_data(argv[i], &df, &opt) != 0 || df.parsed)
+		{
+			printf("\nCant open the binary file %s\n", argv[i]);
+			exit(1);
+		}
+		if(df.tail != 0)
+			printf("\nWarning: the last %d bytes of the file %s are not a complete point", df.tail, argv[i]);
+		index_data(&df, &idx);
+		close_data(&df);
+		if (write_index(argv[i], &idx) != 0)
+		{
+			printf("\nCant write the index file of %s\n", argv[i]);
+			exit(1);
+		}
+		printf("\n%s.idx", argv[i]);
+		printf("\nPoints = %lld, sum of the weights = %.6f", idx.c, idx.w[0] + idx.w[1]);
+		printf("\nBounding box = [%.6f, %.6f] x [%.6f, %.6f] x [%.6f, %.6f]\n", idx.min[0], idx.max[0], idx.min[1], idx.max[1], idx.min[2], idx.max[2]);
+	}
+	return 0;
+}
@@ -0,0 +1,178 @@
+/**
+ * \file		chol_bench.c
+ * \brief       Benchmark of the 9x9 LDL' factorization against cholesky()
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+#define MATRICES 64 /* Number of test matrices of every timed pass */
+
+/**
+ * \brief           Fills a 9x9 symmetric positive definite matrix N = S (A'A + I) S with a random
+ * 					matrix A and a diagonal scaling S of ten orders of magnitude, like the normal
+ * 					matrices of the adjustment (translations, semi-axes and angles)
+ * \param[out]      N: The matrix (9x9, by rows)
+ * \param[out]      P: The same matrix, packed (upper triangle by rows) for the function ldl_factor()
+ * \param[out]      u: A random vector (9)
+ */
+static void random_system(type *N, type *P, type *u)
+{
+	register int i, j, k;
+	type A[9][9], s[9];
+
+	for (i = 0; i < 9; i++)
+	{
+		for (j = 0; j < 9; j++)
+			A[i][j] = (type)rand() / RAND_MAX - 0.5L;
+		s[i] = powl(10.0L, (type)rand() / RAND_MAX * 10.0L - 5.0L);
+		u[i] = (type)rand() / RAND_MAX - 0.5L;
+	}
+	for (i = 0; i < 9; i++)
+		for (j = 0; j < 9; j++)
+		{
+			N[i * 9 + j] = i == j ? 1.0L : 0.0L;
+			for (k = 0; k < 9; k++)
+				N[i * 9 + j] += A[k][i] * A[k][j];
+			N[i * 9 + j] *= s[i] * s[j];
+		}
+	for (i = 0; i < 9; i++)
+		for (j = i; j < 9; j++)
+			P[UPPER(i, j)] = N[i * 9 + j];
+}
+
+/**
+ * \brief           The elapsed time since t0
+ * \param[in]       t0: The start time
+ * \return			The elapsed time (nanoseconds)
+ */
+static double elapsed(struct timespec *t0)
+{
+	struct timespec t1;
+
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	return (t1.tv_sec - t0->tv_sec) * 1e9 + (t1.tv_nsec - t0->tv_nsec);
+}
+
+/**
+ * \brief           Times the solution of N x = u and the inversion of N with the functions
+ * 					cholesky() and multiply() and with the functions ldl_factor(), ldl_solve()
+ * 					and ldl_inverse(), and prints the time per matrix and the largest relative
+ * 					difference of the results
+ * \param[in]       argc: The number of arguments that main was called (integer)
+ * \param[in]       argv: The vector of the arguments: the number of passes (optional)
+ * \return			An integer value equal to zero
+ */
+int main(int argc, char *argv[])
+{
+	register int i, j, m;
+	long p, passes = argc > 1 ? atol(argv[1]) : 20000;
+	type N[MATRICES][81], P[MATRICES][NPACK], u[MATRICES][9], Ninv[81], Ninv2[81], x[9], x2[9];
+	type diff, dsol = 0.0L, dinv = 0.0L, check = 0.0L;
+	double t[5];
+	struct ldl f;
+	struct timespec t0;
+
+	if (passes < 1)
+	{
+		printf("\nUsage: %s [passes]\n", argv[0]);
+		exit(1);
+	}
+	srand(1);
+	for (m = 0; m < MATRICES; m++)
+		random_system(&N[m][0], &P[m][0], &u[m][0]);
+	/* The largest relative differences of the two methods */
+	for (m = 0; m < MATRICES; m++)
+	{
+		cholesky(&N[m][0], &Ninv[0], 9);
+		multiply(&Ninv[0], &u[m][0], &x[0], 9, 9, 1);
+		ldl_factor(&P[m][0], &f);
+		ldl_solve(&f, &u[m][0], &x2[0]);
+		ldl_inverse(&f, &Ninv2[0], true);
+		for (i = 0; i < 9; i++)
+		{
+			diff = MYABS(x[i] - x2[i]) / MYABS(x[i]);
+			dsol = diff > dsol ? diff : dsol;
+			for (j = 0; j < 9; j++)
+			{
+				diff = MYABS(Ninv[i * 9 + j] - Ninv2[i * 9 + j]) / sqrtl(Ninv[i * 9 + i] * Ninv[j * 9 + j]);
+				dinv = diff > dinv ? diff : dinv;
+			}
+		}
+	}
+	/* Solution of N x = u */
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (p = 0; p < passes; p++)
+		for (m = 0; m < MATRICES; m++)
+		{
+			cholesky(&N[m][0], &Ninv[0], 9);
+			multiply(&Ninv[0], &u[m][0], &x[0], 9, 9, 1);
+			check += x[0];
+		}
+	t[0] = elapsed(&t0);
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (p = 0; p < passes; p++)
+		for (m = 0; m < MATRICES; m++)
+		{
+			ldl_factor(&P[m][0], &f);
+			ldl_solve(&f, &u[m][0], &x[0]);
+			check += x[0];
+		}
+	t[1] = elapsed(&t0);
+	/* Inversion of N */
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (p = 0; p < passes; p++)
+		for (m = 0; m < MATRICES; m++)
+		{
+			cholesky(&N[m][0], &Ninv[0], 9);
+			check += Ninv[80];
+		}
+	t[2] = elapsed(&t0);
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (p = 0; p < passes; p++)
+		for (m = 0; m < MATRICES; m++)
+		{
+			ldl_factor(&P[m][0], &f);
+			ldl_inverse(&f, &Ninv[0], true);
+			check += Ninv[80];
+		}
+	t[3] = elapsed(&t0);
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (p = 0; p < passes; p++)
+		for (m = 0; m < MATRICES; m++)
+		{
+			ldl_factor(&P[m][0], &f);
+			ldl_inverse(&f, &Ninv[0], false);
+			check += Ninv[80];
+		}
+	t[4] = elapsed(&t0);
+	for (i = 0; i < 5; i++)
+		t[i] /= (double)passes * MATRICES;
+	printf("\n%ld x %d matrices 9x9 (checksum %.6Le)", passes, MATRICES, check);
+	printf("\n%-9s%-30s %8.1f ns", "solve:", "cholesky() + multiply()", t[0]);
+	printf("\n%-9s%-30s %8.1f ns (%.2fx)", "", "ldl_factor() + ldl_solve()", t[1], t[0] / t[1]);
+	printf("\n%-9s%-30s %8.1f ns", "inverse:", "cholesky()", t[2]);
+	printf("\n%-9s%-30s %8.1f ns (%.2fx)", "", "ldl_factor() + ldl_inverse()", t[3], t[2] / t[3]);
+	printf("\n%-9s%-30s %8.1f ns (%.2fx)", "", "diagonal only", t[4], t[2] / t[4]);
+	printf("\nLargest relative difference: solution %.3Le, inverse %.3Le\n", dsol, dinv);
+	return 0;
+}
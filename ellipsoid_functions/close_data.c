@@ -0,0 +1,44 @@
+/**
+ * \file		close_data.c
+ * \brief       Closing of a data file
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Closes a data file and removes its mapping or its parsed points, if any
+ * \param[in]       df: The structure <data_file> of the file
+ */
+void close_data(struct data_file *df)
+{
+	if (df->parsed)
+		free(df->map);
+	else if (df->map != NULL)
+		munmap(df->map, df->map_size);
+	if (df->qmap != NULL)
+		munmap(df->qmap, df->map_size);
+	free(df->offsets);
+	if (df->fp != NULL)
+		fclose(df->fp);
+	df->map = NULL;
+}
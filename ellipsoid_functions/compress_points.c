@@ -0,0 +1,154 @@
+/**
+ * \file		compress_points.c
+ * \brief       Conversion of data files into the compressed format
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Converts a data file (binary, text, quantized or compressed file) into
+ * 					a compressed file (extension .cbin) and its index file. The points are
+ * 					quantized (function quant_init()) and every block of BLOCK points is
+ * 					compressed independently (function pack_block()), so that the blocks
+ * 					can be decompressed in parallel. The compression ratio and the
+ * 					worst-case quantization errors are reported
+ * \param[in]       argc: The number of arguments that main was called (integer)
+ * \param[in]       argv: The vector of arguments (string) which contains
+ * 					the options, the name of the input file and the name of the output file
+ * \return			Zero on success, or one on failure
+ */
+int main(int argc, char *argv[])
+{
+	register int i;
+	int first;
+	long b, j, k, m, n;
+	long long pos, *offsets;
+	double e;
+	size_t size;
+	char *out_name;
+	struct cart_coord buf[BLOCK], src[BLOCK], dec[BLOCK];
+	unsigned char rec[BLOCK * 16], blk[COMP_BLOCK_MAX];
+	struct span sp;
+	struct data_file df, cf;
+	struct point_index idx;
+	struct comp_header ch;
+	struct options opt;
+	struct stat st;
+	FILE *out;
+
+	if ((first = options(argc, argv, &opt)) < 0 || argc - first != 2)
+	{
+		printf("\nUsage: %s [-j threads] [-m] input.bin|.txt|.qbin output.cbin\n", argv[0]);
+		exit(1);
+	}
+	out_name = argv[first + 1];
+	if (strrchr(out_name, '.') == NULL || strcmp(strrchr(out_name, '.'), ".cbin") != 0)
+	{
+		printf("\nThe name of the output file must end with .cbin\n");
+		exit(1);
+	}
+	if (open_data(argv[first], &df, &opt) != 0)
+	{
+		printf("\nCant open the file %s\n", argv[first]);
+		exit(1);
+	}
+	memset(&ch, 0, sizeof(ch));
+	memcpy(ch.magic, COMP_MAGIC, sizeof(ch.magic));
+	ch.version = COMP_VERSION;
+	ch.block = BLOCK;
+	ch.c = df.c;
+	ch.blocks = (df.c + BLOCK - 1) / BLOCK;
+	quant_init(&df, &ch.qh);
+	if ((offsets = malloc((ch.blocks + 1) * sizeof(long long))) == NULL)
+	{
+		printf("\nNot enough memory\n");
+		exit(1);
+	}
+	/* Writing the header, the blocks and, at the end, the header with the errors and the offsets */
+	if ((out = fopen(out_name, "wb")) == NULL || fwrite(&ch, sizeof(ch), 1, out) != 1
+			|| fwrite(offsets, sizeof(long long), ch.blocks + 1, out) != (size_t)(ch.blocks + 1))
+	{
+		printf("\nCant write the file %s\n", out_name);
+		exit(1);
+	}
+	pos = sizeof(ch) + (ch.blocks + 1) * sizeof(long long);
+	for (b = 0; b < ch.blocks; b++)
+	{
+		m = (df.c - b * BLOCK < BLOCK) ? df.c - b * BLOCK : BLOCK;
+		for (k = 0; k < m && (n = fetch_points(&df, b * BLOCK + k, m - k, buf, &sp)) > 0; k += n)
+			for (j = 0; j < n; j++)
+			{
+				src[k + j].x = sp.x[j * sp.stride];
+				src[k + j].y = sp.y[j * sp.stride];
+				src[k + j].z = sp.z[j * sp.stride];
+				src[k + j].w = sp.w[j * sp.stride];
+			}
+		encode_points(src, m, &ch.qh, rec);
+		size = pack_block(rec, m, &ch.qh, blk);
+		if (fwrite(blk, 1, size, out) != size)
+		{
+			printf("\nCant write the file %s\n", out_name);
+			exit(1);
+		}
+		offsets[b] = pos;
+		pos += size;
+		unpack_block(blk, size, m, &ch.qh, dec);
+		for (j = 0; j < m; j++)
+		{
+			ch.qh.error[0] = fmax(ch.qh.error[0], fabs(dec[j].x - src[j].x));
+			ch.qh.error[1] = fmax(ch.qh.error[1], fabs(dec[j].y - src[j].y));
+			ch.qh.error[2] = fmax(ch.qh.error[2], fabs(dec[j].z - src[j].z));
+			ch.qh.error[3] = fmax(ch.qh.error[3], fabs(dec[j].w - src[j].w));
+		}
+	}
+	offsets[ch.blocks] = pos;
+	close_data(&df);
+	if (fseek(out, 0, SEEK_SET) != 0 || fwrite(&ch, sizeof(ch), 1, out) != 1
+			|| fwrite(offsets, sizeof(long long), ch.blocks + 1, out) != (size_t)(ch.blocks + 1) || fclose(out) != 0)
+	{
+		printf("\nCant write the file %s\n", out_name);
+		exit(1);
+	}
+	free(offsets);
+	/* The index of the compressed file is calculated from the decompressed points */
+	opt.io = IO_STDIO;
+	if (open_data(out_name, &cf, &opt) != 0)
+	{
+		printf("\nCant open the file %s\n", out_name);
+		exit(1);
+	}
+	index_data(&cf, &idx);
+	close_data(&cf);
+	if (write_index(out_name, &idx) != 0)
+		printf("\nWarning: cant write the index file of %s", out_name);
+	stat(out_name, &st);
+	printf("\n%s -> %s", argv[first], out_name);
+	printf("\nPoints = %lld in %lld blocks (%s weight)", idx.c, ch.blocks, (ch.qh.record == 12) ? "common" : "float");
+	printf("\nSize = %lld bytes, %.2f bytes per point (%.1f times smaller than the binary file)", (long long)st.st_size,
+			idx.c > 0 ? (double)st.st_size / idx.c : 0.0, st.st_size > 0 ? 32.0 * idx.c / st.st_size : 0.0);
+	for (i = 0, e = 0.0; i < 3; i++)
+		e = fmax(e, ch.qh.error[i]);
+	printf("\nMaximum quantization error: x = %.3e, y = %.3e, z = %.3e, w = %.3e", ch.qh.error[0], ch.qh.error[1], ch.qh.error[2], ch.qh.error[3]);
+	printf("\nMaximum coordinate error = %.3e\n", e);
+	return 0;
+}
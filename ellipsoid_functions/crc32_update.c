@@ -0,0 +1,49 @@
+/**
+ * \file		crc32_update.c
+ * \brief       CRC-32 checksum
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Updates the CRC-32 checksum (polynomial 0xEDB88320, as in zlib) of a
+ * 					sequence of bytes with the next bytes
+ * \param[in]       crc: The checksum of the previous bytes (zero at the beginning)
+ * \param[in]       data: The next bytes
+ * \param[in]       size: The number of the next bytes
+ * \return			The checksum of all the bytes
+ */
+unsigned int crc32_update(unsigned int crc, const void *data, size_t size)
+{
+	register int k;
+	const unsigned char *p = data;
+
+	crc = ~crc;
+	while (size--)
+	{
+		crc ^= *p++;
+		for (k = 0; k < 8; k++)
+			crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1u));
+	}
+	return ~crc;
+}
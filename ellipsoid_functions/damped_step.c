@@ -0,0 +1,131 @@
+/**
+ * \file		damped_step.c
+ * \brief       Step control of the iterations (step halving or Levenberg-Marquardt damping)
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Solves the damped normal equations (N + lambda diag(N)) delta = u
+ * \param[in]       g: The structure <group> of the matrix N and the vector u
+ * \param[in]       lambda: The damping factor
+ * \param[out]      delta: Vector of the 9 damped corrections
+ */
+static void lm_solve(struct group *g, type lambda, type *delta)
+{
+	register int i;
+	type N[NPACK];
+	struct ldl f;
+
+	memcpy(N, g->N_bar, sizeof(N));
+	for (i = 0; i < 9; i++)
+		N[UPPER(i, i)] *= 1.0L + lambda;
+	ldl_factor(&N[0], &f);
+	ldl_solve(&f, &g->U_bar[0], delta);
+}
+
+/**
+ * \brief           Calculates the parameters of the next pass over the points. Without step
+ * 					control the Gauss-Newton correction is added to the parameters. Otherwise
+ * 					the parameters are tested with the natural monotonicity test: the vector u
+ * 					of the pass is solved with the matrix N of the last accepted parameters and
+ * 					the level u' N^-1 u is compared with the one of the accepted parameters.
+ * 					The level vanishes only at the solution of the adjustment, so that the step
+ * 					control does not move the solution. If the level decreases (by the factor
+ * 					(1 - scale / 4)^2 for step halving), the parameters are accepted and the
+ * 					next ones are calculated from them with the whole Gauss-Newton correction
+ * 					(step halving) or with a ten times smaller damping factor (Levenberg-
+ * 					Marquardt). Else they are rejected and the next parameters are calculated
+ * 					from the last accepted ones with half the previous step or with a ten times
+ * 					larger damping factor, without reading the points again
+ * \param[in,out]   dm: The structure <damping> of the step control (member started false
+ * 					before the first iteration)
+ * \param[in]       mat: The structure <group> of the pass at the parameters
+ * \param[in]       ds: Vector of the Gauss-Newton corrections at the parameters (N ds = u)
+ * \param[in,out]   values: Vector of the parameters of the pass, which receives
+ * 					the parameters of the next pass
+ * \param[out]      step: Vector of the corrections of the next parameters
+ * 					with respect to the last accepted parameters
+ * \param[in]       opt: The run-time options (step control)
+ * \return			True if the parameters of the pass are accepted
+ */
+bool damped_step(struct damping *dm, struct group *mat, type *ds, type *values, type *step, struct options *opt)
+{
+	register int i;
+	type bar[9], level = 0.0L, limit = 1.0L;
+	bool accepted = true;
+
+	if (opt->damping == DAMP_NONE)
+	{
+		for (i = 0; i < 9; i++)
+		{
+			step[i] = ds[i];
+			values[i] += ds[i];
+		}
+		return true;
+	}
+	if (dm->started)
+	{
+		ldl_solve(&dm->f, &mat->U_bar[0], &bar[0]);
+		for (i = 0; i < 9; i++)
+			level += mat->U_bar[i] * bar[i];
+		if (opt->damping == DAMP_HALVING)
+			limit = (1.0L - dm->scale / 4.0L) * (1.0L - dm->scale / 4.0L);
+		accepted = level <= limit * dm->level || level <= LEVEL_TOL * mat->sum_piwi2;
+	}
+	if (accepted)
+	{
+		if (!dm->started)
+		{
+			dm->lambda = LM_LAMBDA;
+			dm->rejected = 0;
+		}
+		else
+			dm->lambda /= 10.0L;
+		dm->started = true;
+		dm->g = *mat;
+		ldl_factor(&dm->g.N_bar[0], &dm->f);
+		dm->scale = 1.0L;
+		dm->level = 0.0L;
+		for (i = 0; i < 9; i++)
+		{
+			dm->x[i] = values[i];
+			dm->ds[i] = ds[i];
+			dm->level += mat->U_bar[i] * ds[i];
+		}
+	}
+	else
+	{
+		dm->lambda *= 10.0L;
+		dm->scale /= 2.0L;
+		dm->rejected++;
+	}
+	if (opt->damping == DAMP_LM)
+		lm_solve(&dm->g, dm->lambda, step);
+	else
+		for (i = 0; i < 9; i++)
+			step[i] = dm->scale * dm->ds[i];
+	for (i = 0; i < 9; i++)
+		values[i] = dm->x[i] + step[i];
+	return accepted;
+}
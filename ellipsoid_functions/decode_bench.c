@@ -0,0 +1,159 @@
+/**
+ * \file		decode_bench.c
+ * \brief       Benchmark of the decoding of the data files
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+#define REPEAT 3 /* Number of timed passes of every file */
+
+/* A structure for the work of a thread: every threads-th block of BLOCK points of the file */
+struct bench {
+	struct data_file *df;
+	struct model *md;
+	int id;
+	int threads;
+	double check;
+	struct group part;
+};
+
+/**
+ * \brief           Reads (and decodes) the blocks of a thread and, if a model is given,
+ * 					accumulates them with its kernel
+ * \param[in]       arg: A pointer to the structure <bench> of the thread
+ * \return			A null pointer
+ */
+static void *bench_worker(void *arg)
+{
+	struct bench *bn = arg;
+	long j, k, n;
+	struct cart_coord buf[BLOCK];
+	struct span sp;
+
+	bn->check = 0.0;
+	bn->part.c = 0;
+	zeros(&bn->part.N_bar[0], NPACK, 1);
+	zeros(&bn->part.U_bar[0], 9, 1);
+	bn->part.sum_piwi2 = 0.0L;
+	bn->part.weight = 0.0L;
+	for (k = (long)bn->id * BLOCK; k < bn->df->c; k += (long)bn->threads * BLOCK)
+		for (j = k; j < k + BLOCK && (n = fetch_points(bn->df, j, k + BLOCK - j, buf, &sp)) > 0; j += n)
+		{
+			if (bn->md != NULL)
+				bn->md->kernel(&sp, bn->md, &bn->part);
+			else
+				bn->check += sp.x[0] + sp.y[(n - 1) * sp.stride] + sp.w[0];
+		}
+	return NULL;
+}
+
+/**
+ * \brief           Measures the best time of REPEAT passes over a file
+ * \param[in]       df: The structure <data_file> of the file
+ * \param[in]       md: The model of the accumulation, or a null pointer for decoding only
+ * \param[in]       threads: The number of threads
+ * \return			The time of the fastest pass (seconds)
+ */
+static double bench_file(struct data_file *df, struct model *md, int threads)
+{
+	register int i, r;
+	double seconds, best = HUGE_VAL;
+	struct timespec t0, t1;
+	struct bench bn[threads];
+	pthread_t tid[threads];
+	bool started[threads];
+
+	for (r = 0; r < REPEAT; r++)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &t0);
+		for (i = 0; i < threads; i++)
+		{
+			bn[i].df = df;
+			bn[i].md = md;
+			bn[i].id = i;
+			bn[i].threads = threads;
+			started[i] = i > 0 && pthread_create(&tid[i], NULL, bench_worker, &bn[i]) == 0;
+		}
+		for (i = 0; i < threads; i++)
+		{
+			if (started[i])
+				pthread_join(tid[i], NULL);
+			else
+				bench_worker(&bn[i]);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &t1);
+		seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+		best = (seconds < best) ? seconds : best;
+	}
+	return best;
+}
+
+/**
+ * \brief           Measures the throughput of the decoding of data files of any format
+ * 					(binary, quantized or compressed), alone and followed by the
+ * 					accumulation of the matrix N, with the same threads, input backend and
+ * 					kernel as the programs, so that the formats of the same points can be
+ * 					compared with the raw binary files
+ * \param[in]       argc: The number of arguments that main was called (integer)
+ * \param[in]       argv: The vector of arguments (string) which contains
+ * 					the options and the names of the data files
+ * \return			Zero on success, or one on failure
+ */
+int main(int argc, char *argv[])
+{
+	register int i;
+	int first;
+	double t_dec, t_acc, mbytes;
+	type values[9];
+	struct data_file df;
+	struct model md;
+	struct options opt;
+	struct stat st;
+
+	if ((first = options(argc, argv, &opt)) < 0 || first == argc)
+	{
+		printf("\nUsage: %s [-j threads] [-m] [-s] file1.bin|.qbin|.cbin [file2 ...]\n", argv[0]);
+		exit(1);
+	}
+	printf("\n%-32s %10s %12s %12s %12s %12s", "File", "Points", "Bytes/point", "Decode MP/s", "Decode MB/s", "Pass MP/s");
+	for (i = first; i < argc; i++)
+	{
+		if (open_data(argv[i], &df, &opt) != 0 || stat(argv[i], &st) != 0)
+		{
+			printf("\nCant open the file %s\n", argv[i]);
+			exit(1);
+		}
+		/* The accumulation uses the model at the initial values of the file */
+		initial_values(&df, 1, values, &opt);
+		model_coefficients(values, &md);
+		select_kernel(&md, &opt);
+		t_dec = bench_file(&df, NULL, opt.threads);
+		t_acc = bench_file(&df, &md, opt.threads);
+		mbytes = st.st_size / 1048576.0;
+		printf("\n%-32s %10ld %12.2f %12.1f %12.1f %12.1f", argv[i], df.c, df.c > 0 ? (double)st.st_size / df.c : 0.0,
+				df.c / t_dec * 1e-6, mbytes / t_dec, df.c / t_acc * 1e-6);
+		close_data(&df);
+	}
+	printf("\n\nThreads = %d, kernel = %s\n", opt.threads, opt.simd ? simd_name() : "long double");
+	return 0;
+}
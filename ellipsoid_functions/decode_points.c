@@ -0,0 +1,56 @@
+/**
+ * \file		decode_points.c
+ * \brief       Decoding of points from the quantized format
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Decodes records of the quantized format into points (structures
+ * 					<cart_coord>), which are used directly by the accumulation kernels.
+ * 					The records may be stored at the end of the buffer of the points
+ * \param[in]       rec: The records (n * qh->record bytes)
+ * \param[in]       n: The number of points
+ * \param[in]       qh: The header of the quantized file
+ * \param[out]      pts: The points
+ */
+void decode_points(const unsigned char *rec, long n, struct quant_header *qh, struct cart_coord *pts)
+{
+	long k;
+	int X[3];
+	float w = 0.0f;
+	double sx = qh->scale[0], sy = qh->scale[1], sz = qh->scale[2];
+	double ox = qh->offset[0], oy = qh->offset[1], oz = qh->offset[2];
+
+	for (k = 0; k < n; k++, rec += qh->record)
+	{
+		/* The record is read before the point is written, since they may overlap */
+		memcpy(X, rec, sizeof(X));
+		if (qh->record > (int)sizeof(X))
+			memcpy(&w, rec + sizeof(X), sizeof(w));
+		pts[k].x = ox + sx * X[0];
+		pts[k].y = oy + sy * X[1];
+		pts[k].z = oz + sz * X[2];
+		pts[k].w = (qh->record > (int)sizeof(X)) ? w : qh->weight;
+	}
+}
@@ -0,0 +1,74 @@
+/**
+ * \file		downdate.c
+ * \brief       Removal of a group from the sequential adjustment
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Removes the measurements of a group from a solution of the sequential
+ * 					adjustment (downdating), without reading its points. The normal vector
+ * 					and the weighted sum of squares of the group at the current solution x
+ * 					are obtained from their values at the linearization point xk of the
+ * 					group: u = U - N (x - xk) and w = W - 2 U'(x - xk) + (x - xk)' N (x - xk).
+ * 					Then N' = N - Nk, x' = x - N'^-1 u, r' = r - ck and
+ * 					r' s02' = r s02 - w - u' N'^-1 u
+ * \param[in]       x: The structure <solution> which contains the current solution
+ * \param[in]       Mk: The structure <group> of the removed measurements
+ * \param[in]       xk: The linearization point of the structure Mk
+ * \return			The solution without the measurements of the group
+ */
+struct solution downdate(struct solution x, struct group *Mk, type *xk)
+{
+	struct solution x1;
+	struct ldl f;
+	type d[9], u[9], Nd[9], dx[9], w, uNu = 0.0L, dNd = 0.0L, Ud = 0.0L;
+	register int i;
+
+	/* The difference of the current solution from the linearization point of the group */
+	for (i = 0; i < 9; i++)
+		d[i] = x.x[i] - xk[i];
+	packed_multiply(&Mk->N_bar[0], &d[0], &Nd[0]);
+	for (i = 0; i < 9; i++)
+	{
+		u[i] = Mk->U_bar[i] - Nd[i];
+		Ud += Mk->U_bar[i] * d[i];
+		dNd += d[i] * Nd[i];
+	}
+	w = Mk->sum_piwi2 - 2.0L * Ud + dNd;
+	/* Calculating the matrix N without the group (N' = N - Nk) */
+	memcpy(x1.Nbar, x.Nbar, sizeof(x1.Nbar));
+	packed_axpy(&x1.Nbar[0], -1.0L, &Mk->N_bar[0]);
+	/* Solving N' dx = u by calling the functions ldl_factor() and ldl_solve() */
+	ldl_factor(&x1.Nbar[0], &f);
+	ldl_solve(&f, &u[0], &dx[0]);
+	x1.r = x.r - Mk->c; /* Degrees of freedom */
+	for (i = 0; i < 9; i++)
+	{
+		x1.x[i] = x.x[i] - dx[i];
+		uNu += u[i] * dx[i];
+	}
+	/* Calculating the a-posteriori variance factor without the group */
+	x1.s02 = (x.r * x.s02 - w - uNu) / x1.r;
+	return x1;
+}
@@ -0,0 +1,85 @@
+/**
+ * \file	ellipsoid.h
+ * \brief       This header file contains the interface of the library
+ *		libellipsoid: the reentrant least-squares fitting of a triaxial
+ *		ellipsoid to points of files or of the memory of the caller
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#ifndef ELLIPSOID_H
+#define ELLIPSOID_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ELLIPSOID_OK 0 /* Status: success */
+#define ELLIPSOID_EINVAL -1 /* Status: invalid argument */
+#define ELLIPSOID_ENOMEM -2 /* Status: not enough memory */
+#define ELLIPSOID_EIO -3 /* Status: the data file cannot be opened */
+#define ELLIPSOID_EFEW -4 /* Status: fewer than 10 points */
+#define ELLIPSOID_ESINGULAR -5 /* Status: the initial values or the solution cannot be calculated */
+
+/* The context of a fit: the options and the added points. A context is used by one
+ * thread at a time, while different contexts can be used by concurrent threads */
+typedef struct ellipsoid_ctx ellipsoid_ctx;
+
+/* A structure for points in the memory of the caller: the arrays of the Cartesian
+ * coordinates and of the weights, with stride doubles between consecutive points
+ * (1 for separate arrays, 4 for an array of points x, y, z, w) */
+struct ellipsoid_points {
+	const double *x;
+	const double *y;
+	const double *z;
+	const double *w;
+	long n;
+	long stride;
+};
+
+/* A structure for the result of a fit: the parameters tx, ty, tz, ax, ay, az [m] and
+ * theta_x, theta_y, theta_z [rad], their variance-covariance matrix Vx, the a-posteriori
+ * variance factor s02 and the statistics of the iterations */
+struct ellipsoid_result {
+	long double x[9];
+	long double Vx[9][9];
+	long double s02;
+	long c; /* Number of points */
+	long r; /* Degrees of freedom */
+	int iterations;
+	bool converged; /* False if the iterations stopped at their limit */
+};
+
+int ellipsoid_create(ellipsoid_ctx **ctx, int threads, bool simd);
+int ellipsoid_add_points(ellipsoid_ctx *ctx, const struct ellipsoid_points *pts);
+int ellipsoid_add_file(ellipsoid_ctx *ctx, const char *name);
+int ellipsoid_fit(ellipsoid_ctx *ctx, struct ellipsoid_result *res);
+void ellipsoid_clear(ellipsoid_ctx *ctx);
+void ellipsoid_destroy(ellipsoid_ctx *ctx);
+const char *ellipsoid_strerror(int status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,51 @@
+/**
+ * \file		ellipsoid_add_file.c
+ * \brief       Data file of a fit context
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Opens a data file (of any format of the programs) and adds its points
+ * 					to a fit context. The file stays open until the context is cleared
+ * \param[in,out]   ctx: The fit context
+ * \param[in]       name: The name of the data file
+ * \return			ELLIPSOID_OK, ELLIPSOID_EINVAL, ELLIPSOID_ENOMEM or ELLIPSOID_EIO
+ */
+int ellipsoid_add_file(ellipsoid_ctx *ctx, const char *name)
+{
+	struct data_file *df;
+	char *copy;
+
+	if (ctx == NULL || name == NULL)
+		return ELLIPSOID_EINVAL;
+	if ((df = new_source(ctx)) == NULL || (copy = strdup(name)) == NULL)
+		return ELLIPSOID_ENOMEM;
+	if (open_data(copy, df, &ctx->opt) != 0)
+	{
+		free(copy);
+		return ELLIPSOID_EIO;
+	}
+	ctx->count++;
+	return ELLIPSOID_OK;
+}
@@ -0,0 +1,52 @@
+/**
+ * \file		ellipsoid_add_points.c
+ * \brief       Points of the caller of a fit context
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Adds points in the memory of the caller to a fit context. The points are
+ * 					not copied, so the arrays must not change until the context is cleared
+ * \param[in,out]   ctx: The fit context
+ * \param[in]       pts: The structure <ellipsoid_points> of the arrays of the points
+ * \return			ELLIPSOID_OK, ELLIPSOID_EINVAL or ELLIPSOID_ENOMEM
+ */
+int ellipsoid_add_points(ellipsoid_ctx *ctx, const struct ellipsoid_points *pts)
+{
+	struct data_file *df;
+
+	if (ctx == NULL || pts == NULL || pts->x == NULL || pts->y == NULL || pts->z == NULL || pts->w == NULL || pts->n < 0 || pts->stride < 1)
+		return ELLIPSOID_EINVAL;
+	if ((df = new_source(ctx)) == NULL)
+		return ELLIPSOID_ENOMEM;
+	/* The points are only read, like the cached points of a data file */
+	df->x = (double *)pts->x;
+	df->y = (double *)pts->y;
+	df->z = (double *)pts->z;
+	df->w = (double *)pts->w;
+	df->stride = pts->stride;
+	df->c = pts->n;
+	ctx->count++;
+	return ELLIPSOID_OK;
+}
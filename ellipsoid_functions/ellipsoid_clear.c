@@ -0,0 +1,46 @@
+/**
+ * \file		ellipsoid_clear.c
+ * \brief       Removal of the points of a fit context
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Removes all the points of a fit context and closes its data files,
+ * 					so that the context can be used for a new fit
+ * \param[in,out]   ctx: The fit context
+ */
+void ellipsoid_clear(ellipsoid_ctx *ctx)
+{
+	register int i;
+
+	if (ctx == NULL)
+		return;
+	for (i = 0; i < ctx->count; i++)
+		if (ctx->files[i].name != NULL)
+		{
+			close_data(&ctx->files[i]);
+			free(ctx->files[i].name);
+		}
+	ctx->count = 0;
+}
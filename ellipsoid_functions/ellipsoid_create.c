@@ -0,0 +1,78 @@
+/**
+ * \file		ellipsoid_create.c
+ * \brief       Creation of a fit context of the library
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Creates a fit context without points
+ * \param[out]      ctx: The new context
+ * \param[in]       threads: The number of threads of the fit (0 for all the processors)
+ * \param[in]       simd: True for the double precision vector kernel, false for the long double one
+ * \return			ELLIPSOID_OK, ELLIPSOID_EINVAL or ELLIPSOID_ENOMEM
+ */
+int ellipsoid_create(ellipsoid_ctx **ctx, int threads, bool simd)
+{
+	struct ellipsoid_ctx *cx;
+
+	if (ctx == NULL || threads < 0)
+		return ELLIPSOID_EINVAL;
+	if ((cx = malloc(sizeof(struct ellipsoid_ctx))) == NULL)
+		return ELLIPSOID_ENOMEM;
+	/* The options of the command line of the programs, with their default values */
+	cx->opt.threads = threads > 0 ? threads : sysconf(_SC_NPROCESSORS_ONLN);
+	cx->opt.io = IO_STDIO;
+	cx->opt.cache = 0;
+	cx->opt.simd = simd;
+	cx->opt.validate = false;
+	cx->opt.stream = 0;
+	cx->opt.block = STREAM_BLOCK;
+	cx->opt.socket = NULL;
+	cx->opt.spool = NULL;
+	cx->opt.checkpoint = NULL;
+	cx->opt.every = 1;
+	cx->opt.resume = false;
+	cx->opt.window = 0;
+	cx->opt.batch = 1;
+	cx->opt.tolerance = CONVTOL;
+	cx->opt.step_tol = 0.0L;
+	cx->opt.iterations = MAXITER;
+	cx->opt.damping = DAMP_NONE;
+	cx->opt.coarse = 0.0;
+	cx->opt.robust = ROBUST_NONE;
+	cx->opt.tuning = 0.0L;
+	cx->opt.scale = 0.0L;
+	cx->opt.ransac = 0;
+	cx->opt.threshold = 0.0;
+	cx->opt.profile = NULL;
+	cx->opt.perf = false;
+	cx->opt.prof = NULL;
+	if (cx->opt.threads < 1)
+		cx->opt.threads = 1;
+	cx->files = NULL;
+	cx->count = 0;
+	cx->size = 0;
+	*ctx = cx;
+	return ELLIPSOID_OK;
+}
@@ -0,0 +1,39 @@
+/**
+ * \file		ellipsoid_destroy.c
+ * \brief       Destruction of a fit context of the library
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Closes the data files of a fit context and frees it
+ * \param[in]       ctx: The fit context, or a null pointer
+ */
+void ellipsoid_destroy(ellipsoid_ctx *ctx)
+{
+	if (ctx == NULL)
+		return;
+	ellipsoid_clear(ctx);
+	free(ctx->files);
+	free(ctx);
+}
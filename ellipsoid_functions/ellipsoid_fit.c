@@ -0,0 +1,80 @@
+/**
+ * \file		ellipsoid_fit.c
+ * \brief       Least-squares fitting of the points of a fit context
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Fits a triaxial ellipsoid to all the points of a fit context, as the
+ * 					program separation_in_groups: the initial values from the moment sums
+ * 					and the iterative adjustment (function iterate_adjustment()), until the
+ * 					iterations converge. Nothing is printed and the points are not changed
+ * \param[in]       ctx: The fit context
+ * \param[out]      res: The structure <ellipsoid_result> of the fit
+ * \return			ELLIPSOID_OK, ELLIPSOID_EINVAL, ELLIPSOID_ENOMEM, ELLIPSOID_EFEW
+ * 					or ELLIPSOID_ESINGULAR
+ */
+int ellipsoid_fit(ellipsoid_ctx *ctx, struct ellipsoid_result *res)
+{
+	register int i, j;
+	int t, rc;
+	long c;
+	type N_inv[9][9];
+	struct group *mat;
+	struct adjustment adj;
+
+	if (ctx == NULL || res == NULL || (t = ctx->count) < 1)
+		return ELLIPSOID_EINVAL;
+	/* Calculating the total number of points and the initial values by calling the function initial_values() */
+	for (i = 0, c = 0; i < t; i++)
+		c += ctx->files[i].c;
+	if (c < 10)
+		return ELLIPSOID_EFEW;
+	if (initial_values(ctx->files, t, &adj.x[0], &ctx->opt) < 0)
+		return ELLIPSOID_ESINGULAR;
+	if ((mat = malloc(t * sizeof(struct group))) == NULL)
+		return ELLIPSOID_ENOMEM;
+	adj.warm = false;
+	/* Iterative adjustment procedure by calling the function iterate_adjustment() */
+	rc = iterate_adjustment(ctx->files, t, &adj, &ctx->opt, mat);
+	free(mat);
+	if (rc == -1)
+		return ELLIPSOID_ENOMEM;
+	if (rc != 0 || !isfinite(adj.sigma0ip1))
+		return ELLIPSOID_ESINGULAR;
+	/* Calculating the variance-covariance matrix from the factorization of the last iteration */
+	ldl_inverse(&adj.f, &N_inv[0][0], true);
+	for (i = 0; i < 9; i++)
+	{
+		res->x[i] = adj.x[i];
+		for (j = 0; j < 9; j++)
+			res->Vx[i][j] = adj.sigma0ip1 * adj.sigma0ip1 * N_inv[i][j];
+	}
+	res->s02 = adj.sigma0ip1 * adj.sigma0ip1;
+	res->c = c;
+	res->r = c - 9;
+	res->iterations = adj.iteration;
+	res->converged = adj.converged;
+	return ELLIPSOID_OK;
+}
@@ -31,25 +31,91 @@
 #include <string.h>
 #include <stdbool.h>
 #include <time.h>
+#include <locale.h>
+#include <pthread.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <dirent.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/resource.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "ellipsoid.h"
 
 #define type long double /* Data type */
 #define MYABS(x) (((x)>0) ? (x):-(x)) /* A macro function that returns the absolute value of a number (inline function) */
+#define NPACK 45 /* Number of the distinct elements of the symmetric 9x9 matrix N (upper triangle by rows) */
+#define UPPER(i, j) ((i) <= (j) ? (i) * (17 - (i)) / 2 + (j) : (j) * (17 - (j)) / 2 + (i)) /* Index of the element (i, j) of a packed matrix N */
 #define RDEG 180.0L / M_PI /* A constant value for the conversion from rad to degrees */
 #define CONVTOL 1e-5 /* Convergence tolerance */
-
-int digitc(type);
-void max_abs_column(type *, type *, int, int);
-void display(type *, int, int, int, char []);
-void zeros(type *, int, int);
-void symmetric(type *, int);
-void cholesky(type *, type *, int);
-void multiply(type *, type *, type *, int, int, int);
-int initial_values(FILE **, int, type *);
-void alpha_sort(char *[], int);
-
-struct solution sequential(FILE *, struct solution);
-struct group direct_calculation(FILE *, type *);
-struct group summary(struct group *, int);
+#define MAXITER 10 /* Default maximum number of iterations */
+#define DAMP_NONE 0 /* Step control: Gauss-Newton corrections */
+#define DAMP_HALVING 1 /* Step control: halving of the rejected steps */
+#define DAMP_LM 2 /* Step control: Levenberg-Marquardt damping */
+#define COARSE_MARGIN 4 /* Margin of the coarse iterations over the noise of the subsamples and the tolerances (variance ratio) */
+#define COARSE_PASSES 8 /* Maximum number of the coarse iterations */
+#define ROBUST_NONE 0 /* Weight function of the misclosures: least squares */
+#define ROBUST_HUBER 1 /* Weight function of the misclosures: Huber */
+#define ROBUST_TUKEY 2 /* Weight function of the misclosures: Tukey biweight */
+#define ROBUST_MASK 3 /* Weight function of the misclosures: inliers of the RANSAC pre-fit (zero-one) */
+#define HUBER_K 1.345 /* Default tuning constant of the Huber weights */
+#define TUKEY_C 4.685 /* Default tuning constant of the Tukey biweights */
+#define MASK_K 3.0 /* Default tuning constant of the inlier mask of the RANSAC pre-fit */
+#define RANSAC_SUBSET 9 /* Number of points of every hypothesis of the RANSAC pre-fit (minimal subset) */
+#define RANSAC_POOL 4096 /* Maximum number of points of the pool of the RANSAC pre-fit */
+#define RANSAC_SEED 0x5DEECE66DULL /* Seed of the random subsets of the RANSAC pre-fit */
+#define RANSAC_K 2.5 /* Inliers of the RANSAC pre-fit within RANSAC_K robust scales */
+#define LM_LAMBDA 1e-3L /* Initial damping factor of the Levenberg-Marquardt step control */
+#define LEVEL_TOL 1e-12L /* Level of the step control (relative to the weighted sum of the squared misclosures) which is always accepted (rounding) */
+#define BLOCK 4096 /* Number of points read from a data file at once */
+#define MINRANGE 16384 /* Minimum number of points assigned to a thread */
+#define IO_STDIO 0 /* Input backend: positional reads of the data files */
+#define IO_MMAP 1 /* Input backend: read-only memory mapping of the data files */
+#define CACHE_LINE 64 /* Alignment of the arrays of the point cache (bytes) */
+#define STREAM_BLOCK 65536 /* Default number of points of a streaming buffer */
+#define SIMDTOL 1e-9 /* Tolerance of the normalized differences between the vector and the long double kernels */
+#define INDEX_MAGIC "ELLIPIDX" /* Identifier of the index files */
+#define INDEX_VERSION 1 /* Version of the format of the index files */
+#define QUANT_MAGIC "ELLIPQNT" /* Identifier of the quantized data files */
+#define QUANT_VERSION 1 /* Version of the format of the quantized data files */
+#define QUANT_MAX 2147483647 /* Largest quantized coordinate */
+#define COMP_MAGIC "ELLIPCMP" /* Identifier of the compressed data files */
+#define COMP_VERSION 1 /* Version of the format of the compressed data files */
+#define COMP_BLOCK_MAX (3 * (5 + (33 * BLOCK + 7) / 8) + 4 * BLOCK) /* Largest compressed block (bytes) */
+#define CKPT_MAGIC "ELLIPCKP" /* Identifier of the checkpoint files */
+#define CKPT_VERSION 1 /* Version of the format of the checkpoint files */
+#define SPOOL_INTERVAL 1000 /* Interval of the scans of the spool directory of the daemon (ms) */
+#define GROUP_MAGIC "ELLIPGRP" /* Identifier of the records of the distributed fitting */
+#define GROUP_VERSION 1 /* Version of the format of the records of the distributed fitting */
+#define GROUP_RECORD 1668 /* Size of a record of the distributed fitting (bytes, little-endian) */
+#define GROUP_POLL 10 /* Interval of the polling of the shared directory of the distributed fitting (ms) */
+#define REC_MOMENTS 1 /* Record of the distributed fitting: moment sums (initial values) */
+#define REC_GROUP 2 /* Record of the distributed fitting: contribution N, u of the points at the parameters */
+#define REC_STOP 3 /* Record of the distributed fitting: end of the fit */
+#define BATCH_MAGIC "ELLIPBAT" /* Identifier of the binary output tables of the batch fitting */
+#define BATCH_VERSION 1 /* Version of the format of the binary output tables */
+#define BATCH_ID 64 /* Longest identifier of an object of the batch fitting (with the terminator) */
+#define BATCH_PACK 16 /* Number of small objects which are fitted together (packed into the vector lanes) */
+#define BATCH_OK 0 /* Status of a fit: converged */
+#define BATCH_FEW 1 /* Status of a fit: fewer than 10 points */
+#define BATCH_SINGULAR 2 /* Status of a fit: the normal matrix is not positive definite */
+#define BATCH_READ 3 /* Status of a fit: the points cannot be read */
+#define BATCH_MAXITER 4 /* Status of a fit: the maximum number of iterations was reached before convergence */
+#define PROF_OPEN 0 /* Stage of the instrumentation: opening (and caching) of the data files */
+#define PROF_INITIAL 1 /* Stage of the instrumentation: initial values */
+#define PROF_DIRECT 2 /* Stage of the instrumentation: accumulation of the matrices N and u */
+#define PROF_SUMMARY 3 /* Stage of the instrumentation: summation of the groups */
+#define PROF_SOLVE 4 /* Stage of the instrumentation: solution of the normal equations */
+#define PROF_COVARIANCE 5 /* Stage of the instrumentation: variance-covariance matrix */
+#define PROF_STAGES 6 /* Number of the stages of the instrumentation */
 
 /* A structure for the Cartesian coordinates and their weights */
 struct cart_coord {
@@ -61,17 +127,361 @@ struct cart_coord {
 
 /* A structure for the elements of each group of measurements */
 struct group {
-	int c;
-	type N_bar[9][9];
+	long c;
+	type N_bar[NPACK]; /* Matrix N, packed (upper triangle by rows) */
 	type U_bar[9];
 	type sum_piwi2;
+	type weight; /* Sum of the robust weight factors of the points (c for least squares) */
+};
+
+/* A structure for a group of the sliding window of the sequential adjustments:
+ * its contribution and the solution at which it was linearized */
+struct window_group {
+	struct group g;
+	type xk[9];
 };
 
 /* A structure for the elements of a particular solution after an adjustment process */
 struct solution {
-	int r;
+	long r;
 	type x[9];
-	type Nbar[9][9];
+	type Nbar[NPACK]; /* Matrix N, packed (upper triangle by rows) */
 	type s02;
 };
 
+/* A structure for the LDL' factorization N = L D L' of a 9x9 symmetric positive definite
+ * matrix: the unit lower triangular matrix L (the diagonal is not stored) and the
+ * reciprocals of the diagonal matrix D */
+struct ldl {
+	type L[9][9];
+	type dinv[9];
+};
+
+/* A structure for the state of the step control of the iterations: the last accepted
+ * parameters with their matrix N (and its factorization), vector u, Gauss-Newton
+ * correction and level u' N^-1 u, the fraction of the correction which is applied
+ * (step halving) and the damping factor (Levenberg-Marquardt) */
+struct damping {
+	bool started;
+	type x[9];
+	struct group g;
+	struct ldl f;
+	type ds[9];
+	type level;
+	type scale;
+	type lambda;
+	int rejected; /* Number of the rejected steps */
+};
+
+/* A structure for the state of an iterative adjustment: the parameters, the contribution
+ * (N, u) of the last iteration at its parameters and the factorization of its matrix N,
+ * the corrections of the last iteration, the a-posteriori standard deviations of the last
+ * accepted and of the last iteration and the step control */
+struct adjustment {
+	type x[9];
+	struct group g;
+	struct ldl f;
+	type step[9];
+	type sigma0i, sigma0ip1;
+	struct damping dm;
+	bool accepted;
+	bool converged;
+	bool warm; /* The initial values are the solution of a subsample (coarse iterations) */
+	int iteration; /* Number of the completed iterations */
+};
+
+/* A structure for the moment sums a1, ..., a34 of the algebraic fitting (initial values) */
+struct moments {
+	long c;
+	type a[34];
+};
+
+/* A structure for a record of the distributed fitting: a request of the coordinator (the
+ * parameters and the weight function) or the answer of a worker (the moment sums or the
+ * contribution of its shard of data files), which is stored by the function send_group()
+ * in a portable format: little-endian integers and long double values as pairs of doubles */
+struct group_record {
+	int kind; /* REC_MOMENTS, REC_GROUP or REC_STOP */
+	int shard; /* Number of the shard of the worker */
+	int iteration;
+	unsigned long long run; /* Identifier of the fit */
+	type values[9]; /* Parameters of the contribution */
+	int robust; /* Weight function of the misclosures */
+	type tuning; /* Tuning constant of the weight function */
+	type scale; /* Scale of the robust weights, zero for least squares */
+	struct group g;
+	struct moments mom;
+};
+
+/* A structure for the index file (sidecar file name.idx) of a binary data file, which
+ * keeps the number of points, the bounding box, the sum of the weights and the moment
+ * sums of the file. The sums are stored as pairs of doubles (hi, lo), whose sum keeps
+ * the precision of the long double sums on any platform */
+struct point_index {
+	char magic[8]; /* INDEX_MAGIC */
+	int version; /* INDEX_VERSION */
+	int record; /* Size of a point (bytes) */
+	long long c; /* Number of points */
+	long long size; /* Size of the data file (bytes) */
+	long long mtime; /* Modification time of the data file (seconds) */
+	double min[3], max[3]; /* Bounding box of the points */
+	double w[2]; /* Sum of the weights */
+	double a[34][2]; /* Moment sums a1, ..., a34 */
+};
+
+/* A structure for the header of a quantized data file (extension .qbin). Every point
+ * is stored as three int32 coordinates X, with x = offset + scale * X, followed by a
+ * float weight (16 bytes) or by nothing when all the points have the same weight (12 bytes) */
+struct quant_header {
+	char magic[8]; /* QUANT_MAGIC */
+	int version; /* QUANT_VERSION */
+	int record; /* Size of a point (bytes) */
+	double scale[3], offset[3]; /* Quantization of x, y and z */
+	double weight; /* Common weight of the points (12 byte records) */
+	double error[4]; /* Maximum errors of x, y, z and w */
+};
+
+/* A structure for the header of a compressed data file (extension .cbin). The points
+ * are quantized (structure <quant_header>) and split into independent blocks of BLOCK
+ * points. The header is followed by the offsets of the blocks in the file (blocks + 1
+ * values, the last one is the size of the file) and by the blocks. In a block every
+ * coordinate is stored as the bit width (1 byte), the first value (int32) and the
+ * zigzag encoded differences of the next values packed with this width, followed by
+ * the float weights of the points, if the records of the quantized format have them */
+struct comp_header {
+	char magic[8]; /* COMP_MAGIC */
+	int version; /* COMP_VERSION */
+	int block; /* Number of points of a block */
+	long long c; /* Number of points */
+	long long blocks; /* Number of blocks */
+	struct quant_header qh;
+};
+
+/* A structure for the header of a checkpoint file of the sequential adjustments. It is
+ * followed by the names of the absorbed data files (each one ends with a null
+ * character) and by the CRC-32 checksum of the header and the names */
+struct checkpoint_header {
+	char magic[8]; /* CKPT_MAGIC */
+	int version; /* CKPT_VERSION */
+	int files; /* Number of the absorbed data files */
+	long long names; /* Size of the names (bytes) */
+	long long r; /* Degrees of freedom */
+	double x[9][2]; /* Parameters (hi, lo) */
+	double Nbar[45][2]; /* Upper triangle of the matrix N by rows (hi, lo) */
+	double s02[2]; /* A-posteriori variance factor (hi, lo) */
+};
+
+/* A structure for the header of a binary output table of the batch fitting. It is
+ * followed by one structure <batch_record> for every object, in the order of the manifest */
+struct batch_header {
+	char magic[8];
+	int version;
+	int record; /* Size of a record (bytes) */
+	long objects;
+};
+
+/* A structure for the result of the fitting of an object in the batch fitting (angles in degrees) */
+struct batch_record {
+	char id[BATCH_ID];
+	int status;
+	int c;
+	int iterations;
+	double s0;
+	double x[9];
+	double sx[9];
+};
+
+/* A structure for an opened data file (group of measurements) */
+struct data_file {
+	char *name;
+	FILE *fp;
+	long c; /* Number of complete points */
+	int tail; /* Size of a trailing partial point (bytes) */
+	long bad; /* Number of invalid lines of a text file */
+	bool parsed; /* The points were parsed from a text file into memory */
+	struct cart_coord *map; /* Points in memory: mapped binary file (IO_MMAP backend) or parsed text file */
+	size_t map_size;
+	double *x, *y, *z, *w; /* Cached points or points of the caller (structure of arrays) */
+	long stride; /* Distance of consecutive cached points (doubles) */
+	long long bytes; /* Number of bytes read from the file (instrumentation) */
+	bool quantized; /* The points are stored in the quantized format */
+	struct quant_header qh;
+	unsigned char *qmap; /* Mapped records of a quantized or compressed file (IO_MMAP backend) */
+	long long *offsets; /* Offsets of the blocks of a compressed file */
+	bool indexed; /* The moment sums were read from the index file */
+	struct moments mom;
+};
+
+/* A structure for a span of points, given by the arrays of the coordinates
+ * and the weights and the distance (in doubles) between consecutive points */
+struct span {
+	double *x, *y, *z, *w;
+	long n;
+	int stride;
+};
+
+/* A structure for the coefficients of the linearized model at a given set of parameters
+ * and the kernel which accumulates the matrix N and the vector u */
+struct model {
+	void (*kernel)(struct span *, struct model *, struct group *);
+	type tx, ty, tz;
+	type pxx, pyy, pzz, pxy, pxz, pyz;
+	type dpxx_dax, dpyy_dax, dpzz_dax, dpxy_dax, dpxz_dax, dpyz_dax;
+	type dpxx_day, dpyy_day, dpzz_day, dpxy_day, dpxz_day, dpyz_day;
+	type dpxx_daz, dpyy_daz, dpzz_daz, dpxy_daz, dpxz_daz, dpyz_daz;
+	type dpxx_dthy, dpyy_dthy, dpzz_dthy, dpxy_dthy, dpxz_dthy, dpyz_dthy;
+	type dpxx_dthz, dpyy_dthz, dpzz_dthz, dpxy_dthz, dpxz_dthz, dpyz_dthz;
+	int robust; /* Weight function of the misclosures (ROBUST_NONE, ROBUST_HUBER, ROBUST_TUKEY or ROBUST_MASK) */
+	type tuning; /* Tuning constant of the weight function */
+	type iscale2; /* Reciprocal of the squared scale of the standardized misclosures */
+};
+
+/* A structure for the run-time options given in the command line */
+struct options {
+	int threads;
+	int io;
+	long cache; /* Memory budget of the point cache (MB), zero for no cache */
+	bool simd; /* Double precision vector kernel */
+	bool validate; /* Comparison of the vector kernel with the long double one */
+	int stream; /* Number of streaming buffers, zero for no streaming */
+	long block; /* Number of points of a streaming buffer */
+	char *socket; /* Unix socket of the daemon */
+	char *spool; /* Spool directory of the daemon */
+	char *checkpoint; /* Checkpoint file of the sequential adjustments */
+	int every; /* Number of groups between the checkpoints */
+	bool resume; /* Resumption from the checkpoint */
+	int window; /* Number of groups of the sliding window, zero for all the groups */
+	int batch; /* Number of groups of every sequential update, calculated concurrently at the same parameters */
+	type tolerance; /* Convergence tolerance of the a-posteriori standard deviation */
+	type step_tol; /* Convergence tolerance of the corrections (relative to the largest semi-axis), zero for none */
+	int iterations; /* Maximum number of iterations */
+	int damping; /* Step control (DAMP_NONE, DAMP_HALVING or DAMP_LM) */
+	double coarse; /* Fraction of the points of the first coarse iteration, zero for none */
+	int robust; /* Weight function of the misclosures (ROBUST_NONE, ROBUST_HUBER, ROBUST_TUKEY or ROBUST_MASK) */
+	type tuning; /* Tuning constant of the weight function */
+	type scale; /* Scale of the robust weights (standard deviation of the previous iteration), zero for least squares */
+	long ransac; /* Number of hypotheses of the RANSAC pre-fit, zero for none */
+	double threshold; /* Inlier threshold of the RANSAC pre-fit, zero for least median of squares */
+	char *profile; /* JSON file of the instrumentation report */
+	bool perf; /* Hardware counters (cycles and instructions) of the instrumentation */
+	struct profile *prof; /* Instrumentation of the run, or a null pointer */
+};
+
+/* A structure for the measurements of a stage of the instrumentation: the number of calls,
+ * the monotonic (wall) and the processor (all the threads) times, the processed points,
+ * the bytes read from the data files and the hardware counters */
+struct stage_stats {
+	long calls;
+	double wall, cpu;
+	long long points, bytes;
+	long long cycles, instructions;
+};
+
+/* A structure for the values of the clocks and the counters at the beginning of a stage */
+struct stage_timer {
+	double wall, cpu;
+	long long bytes, cycles, instructions;
+};
+
+/* A structure for an iteration (or an added group) of the adjustment: the a-posteriori
+ * standard deviation, the norm of the corrections of the parameters and the elapsed time */
+struct iteration_stats {
+	int group;
+	int iteration;
+	double sigma0;
+	double step;
+	double time;
+};
+
+/* A structure for the instrumentation of a run: the data files whose bytes are counted,
+ * the descriptors of the hardware counters (-1 without counters), the clocks at the
+ * beginning, the stages and the iterations */
+struct profile {
+	struct data_file *files;
+	int nfiles;
+	int fd[2];
+	double wall, cpu;
+	struct stage_stats stage[PROF_STAGES];
+	struct iteration_stats *iter;
+	int count, size;
+};
+
+/* A structure for the context of a fit of the library (type ellipsoid_ctx of ellipsoid.h):
+ * the options and the sources of the points, which are opened data files or arrays of
+ * the caller (structures <data_file> without a name) */
+struct ellipsoid_ctx {
+	struct options opt;
+	struct data_file *files;
+	int count;
+	int size;
+};
+
+int digitc(type);
+void max_abs_column(type *, type *, int, int);
+void display(type *, int, int, int, char []);
+void zeros(type *, int, int);
+void symmetric(type *, int);
+void cholesky(type *, type *, int);
+void multiply(type *, type *, type *, int, int, int);
+int ldl_factor(type *, struct ldl *);
+void packed_axpy(type *, type, type *);
+void packed_multiply(type *, type *, type *);
+void ldl_solve(struct ldl *, type *, type *);
+void ldl_inverse(struct ldl *, type *, bool);
+long initial_values(struct data_file *, int, type *, struct options *);
+void moment_calculation(struct data_file *, int, struct moments *, struct options *);
+long ransac_fit(struct data_file *, int, type *, type *, struct options *);
+void alpha_sort(char *[], int);
+int open_data(char *, struct data_file *, struct options *);
+void close_data(struct data_file *);
+long fetch_points(struct data_file *, long, long, struct cart_coord *, struct span *);
+double *load_cache(struct data_file *, int, size_t);
+long parse_points(const char *, size_t, int, struct cart_coord **, long *);
+long load_text(char *, int, struct cart_coord **, long *);
+void quant_init(struct data_file *, struct quant_header *);
+void encode_points(struct cart_coord *, long, struct quant_header *, unsigned char *);
+void decode_points(const unsigned char *, long, struct quant_header *, struct cart_coord *);
+size_t pack_block(const unsigned char *, long, struct quant_header *, unsigned char *);
+void unpack_block(const unsigned char *, size_t, long, struct quant_header *, struct cart_coord *);
+void index_data(struct data_file *, struct point_index *);
+int write_index(char *, struct point_index *);
+int read_index(char *, struct point_index *);
+void stream_points(struct data_file *, int, int, long, void (*)(struct span *, void *), void *);
+
+unsigned int crc32_update(unsigned int, const void *, size_t);
+int write_checkpoint(char *, struct solution *, char **, int);
+int read_checkpoint(char *, struct solution *, char ***, int *);
+int send_group(int, struct group_record *);
+int recv_group(int, struct group_record *);
+struct solution first_solution(struct data_file *, type *, struct options *, int *, type *);
+struct solution sequential(struct data_file *, int, struct solution, struct options *, struct group *);
+struct solution downdate(struct solution, struct group *, type *);
+struct group direct_calculation(struct data_file *, type *, struct options *);
+struct group sample_calculation(struct data_file *, type *, struct options *, long);
+struct group summary(struct group *, int);
+void model_coefficients(type *, struct model *);
+void accumulate(struct span *, struct model *, struct group *);
+type robust_weight(type, struct model *);
+void accumulate_simd(struct span *, struct model *, struct group *);
+void accumulate_packed(struct span *, struct model *, struct group *, int);
+const char *simd_name(void);
+void select_kernel(struct model *, struct options *);
+type validate_kernel(struct data_file *, int, type *, struct options *);
+void parallel_calculation(struct data_file *, struct model *, int, struct group *);
+void moment_sums(struct span *, struct moments *);
+void parallel_moments(struct data_file *, int, int, struct moments *);
+int group_calculation(struct data_file *, int, type *, struct options *, struct group *);
+int algebraic_fit(struct moments *, type *);
+int options(int, char *[], struct options *);
+struct data_file *new_source(struct ellipsoid_ctx *);
+double clock_seconds(clockid_t);
+bool damped_step(struct damping *, struct group *, type *, type *, type *, struct options *);
+bool has_converged(type, type, type *, type *, struct options *);
+int adjustment_step(struct adjustment *, struct options *);
+int iterate_adjustment(struct data_file *, int, struct adjustment *, struct options *, struct group *);
+int profile_init(struct profile *, struct data_file *, int, bool);
+void stage_begin(struct profile *, struct stage_timer *);
+void stage_end(struct profile *, int, struct stage_timer *, long long);
+void profile_iteration(struct profile *, int, int, type, type *);
+void profile_free(struct profile *);
+int write_profile(char *, struct profile *, char *, struct options *);
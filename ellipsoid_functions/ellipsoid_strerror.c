@@ -0,0 +1,52 @@
+/**
+ * \file		ellipsoid_strerror.c
+ * \brief       Messages of the status codes of the library
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Gives the message of a status code of the library
+ * \param[in]       status: The status code
+ * \return			The message (a constant string)
+ */
+const char *ellipsoid_strerror(int status)
+{
+	switch (status)
+	{
+	case ELLIPSOID_OK:
+		return "success";
+	case ELLIPSOID_EINVAL:
+		return "invalid argument";
+	case ELLIPSOID_ENOMEM:
+		return "not enough memory";
+	case ELLIPSOID_EIO:
+		return "the data file cannot be opened";
+	case ELLIPSOID_EFEW:
+		return "fewer than 10 points";
+	case ELLIPSOID_ESINGULAR:
+		return "the initial values or the solution cannot be calculated";
+	default:
+		return "unknown status";
+	}
+}
@@ -0,0 +1,62 @@
+/**
+ * \file		encode_points.c
+ * \brief       Encoding of points into the quantized format
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Encodes points into records of the quantized format: the coordinates
+ * 					are rounded to the nearest integers X = (x - offset) / scale and the
+ * 					weight is stored as a float, unless the records have 12 bytes
+ * \param[in]       pts: The points
+ * \param[in]       n: The number of points
+ * \param[in]       qh: The header of the quantized file
+ * \param[out]      rec: The records (n * qh->record bytes)
+ */
+void encode_points(struct cart_coord *pts, long n, struct quant_header *qh, unsigned char *rec)
+{
+	register int i;
+	long k;
+	double v[3], q;
+	int X[3];
+	float w;
+
+	for (k = 0; k < n; k++, rec += qh->record)
+	{
+		v[0] = pts[k].x;
+		v[1] = pts[k].y;
+		v[2] = pts[k].z;
+		for (i = 0; i < 3; i++)
+		{
+			q = nearbyint((v[i] - qh->offset[i]) / qh->scale[i]);
+			X[i] = (q > QUANT_MAX) ? QUANT_MAX : (q < -QUANT_MAX) ? -QUANT_MAX : (int)q;
+		}
+		memcpy(rec, X, sizeof(X));
+		if (qh->record > (int)sizeof(X))
+		{
+			w = pts[k].w;
+			memcpy(rec + sizeof(X), &w, sizeof(w));
+		}
+	}
+}
@@ -0,0 +1,144 @@
+/**
+ * \file		fetch_points.c
+ * \brief       Access to a range of points of a data file
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Gives access to a range of points of a data file. Cached files
+ * 					and the points of the caller return their arrays and mapped files
+ * 					return the mapped points without copying them, while the other
+ * 					files are read (at most BLOCK points) into the buffer without
+ * 					moving the file position indicator, so that several threads can
+ * 					use the same file. The records of quantized files are decoded
+ * 					into the buffer, and the block of a compressed file which contains
+ * 					the first point is decompressed into the buffer. The bytes which are
+ * 					read are added to the member bytes of the file
+ * \param[in]       df: The structure <data_file> of the file
+ * \param[in]       first: The index of the first point of the range
+ * \param[in]       n: The number of points of the range
+ * \param[in]       buf: A buffer of BLOCK points for the files which are not mapped
+ * \param[out]      sp: The span of the available points
+ * \return			The number of available points (zero at the end of the file)
+ */
+long fetch_points(struct data_file *df, long first, long n, struct cart_coord *buf, struct span *sp)
+{
+	ssize_t got;
+	size_t done = 0, size;
+	off_t offset = first * sizeof(struct cart_coord);
+	struct cart_coord *pp = buf;
+	unsigned char *rec;
+	long b, m;
+
+	if (first + n > df->c)
+		n = df->c - first;
+	if (n <= 0)
+		return 0;
+	if (df->x != NULL)
+	{
+		sp->x = df->x + first * df->stride;
+		sp->y = df->y + first * df->stride;
+		sp->z = df->z + first * df->stride;
+		sp->w = df->w + first * df->stride;
+		sp->stride = df->stride;
+		return sp->n = n;
+	}
+	if (df->map != NULL)
+		pp = df->map + first;
+	else if (df->offsets != NULL)
+	{
+		unsigned char raw[COMP_BLOCK_MAX];
+
+		/* The blocks are independent, so that the threads decompress different blocks */
+		b = first / BLOCK;
+		m = (df->c - b * BLOCK < BLOCK) ? df->c - b * BLOCK : BLOCK;
+		size = df->offsets[b + 1] - df->offsets[b];
+		if (df->qmap != NULL)
+			rec = df->qmap + df->offsets[b];
+		else
+		{
+			rec = raw;
+			while (done < size)
+			{
+				got = pread(fileno(df->fp), rec + done, size - done, df->offsets[b] + done);
+				if (got <= 0)
+					break;
+				done += got;
+			}
+			__atomic_fetch_add(&df->bytes, done, __ATOMIC_RELAXED);
+			if (done < size)
+				return 0;
+		}
+		unpack_block(rec, size, m, &df->qh, buf);
+		pp = buf + (first - b * BLOCK);
+		if (n > m - (first - b * BLOCK))
+			n = m - (first - b * BLOCK);
+	}
+	else if (df->quantized)
+	{
+		if (n > BLOCK)
+			n = BLOCK;
+		size = n * df->qh.record;
+		offset = sizeof(struct quant_header) + first * df->qh.record;
+		if (df->qmap != NULL)
+			rec = df->qmap + offset;
+		else
+		{
+			/* The records are read at the end of the buffer and decoded in place */
+			rec = (unsigned char *)(buf + BLOCK) - size;
+			while (done < size)
+			{
+				got = pread(fileno(df->fp), rec + done, size - done, offset + done);
+				if (got <= 0)
+					break;
+				done += got;
+			}
+			__atomic_fetch_add(&df->bytes, done, __ATOMIC_RELAXED);
+			n = done / df->qh.record;
+		}
+		decode_points(rec, n, &df->qh, buf);
+	}
+	else
+	{
+		if (n > BLOCK)
+			n = BLOCK;
+		size = n * sizeof(struct cart_coord);
+		while (done < size)
+		{
+			got = pread(fileno(df->fp), (char *)buf + done, size - done, offset + done);
+			if (got <= 0)
+				break;
+			done += got;
+		}
+		__atomic_fetch_add(&df->bytes, done, __ATOMIC_RELAXED);
+		n = done / sizeof(struct cart_coord);
+	}
+	/* The points of a file are stored as a structure <cart_coord> each */
+	sp->x = &pp->x;
+	sp->y = &pp->y;
+	sp->z = &pp->z;
+	sp->w = &pp->w;
+	sp->stride = sizeof(struct cart_coord) / sizeof(double);
+	return sp->n = n;
+}
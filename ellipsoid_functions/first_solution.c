@@ -0,0 +1,66 @@
+/**
+ * \file		first_solution.c
+ * \brief       First solution of the sequential adjustments
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Calculates the first solution of the sequential adjustments from the
+ * 					points of the first group, by iterating the least-squares adjustment
+ * 					(function iterate_adjustment()) until it converges. The iterations
+ * 					are recorded by the instrumentation of the options (if any)
+ * \param[in]       df: The structure <data_file> of the data file of the first group
+ * \param[in,out]   values: Vector of the initial values, which receives the adjusted parameters
+ * \param[in]       opt: The run-time options (threads, kernel, iterations and instrumentation)
+ * \param[out]      iterations: The number of iterations
+ * \param[out]      sigma0: The a-posteriori standard deviation of the last iteration
+ * \return			The first solution of the sequential adjustment
+ */
+struct solution first_solution(struct data_file *df, type *values, struct options *opt, int *iterations, type *sigma0)
+{
+	register int i;
+	struct group mat;
+	struct solution x1;
+	struct adjustment adj;
+
+	x1.r = df->c - 9;
+	/* Iterative adjustment procedure (only for the first group) */
+	for (i = 0; i < 9; i++)
+		adj.x[i] = values[i];
+	adj.warm = false;
+	if (iterate_adjustment(df, 1, &adj, opt, &mat) != 0)
+	{
+		/* Without a solution the variance factor is not a number */
+		memset(&adj.g, 0, sizeof(adj.g));
+		adj.g.sum_piwi2 = NAN;
+	}
+	/* The solution keeps the matrix N and the sum of the squares of the last pass over the points */
+	memcpy(x1.Nbar, adj.g.N_bar, sizeof(x1.Nbar));
+	for (i = 0; i < 9; i++)
+		x1.x[i] = values[i] = adj.x[i];
+	x1.s02 = adj.g.sum_piwi2 / x1.r;
+	*iterations = adj.iteration;
+	*sigma0 = adj.sigma0ip1;
+	return x1;
+}
@@ -0,0 +1,247 @@
+/**
+ * \file		fit_bench.c
+ * \brief       End-to-end benchmark of the two fitting techniques
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+#define STAGES 6 /* Number of the timed stages */
+
+/* The names of the timed stages */
+static const char *stage_name[STAGES] = {"initial_values", "direct_calculation", "summary", "cholesky (ldl)", "first_solution", "sequential"};
+
+/* A structure for the measurements of a stage: calls, time and processed points */
+struct stage {
+	long calls;
+	double seconds;
+	double points;
+};
+
+/**
+ * \brief           The time of a monotonic clock
+ * \return			The time (seconds)
+ */
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * \brief           Adds a call to the measurements of a stage
+ * \param[in,out]   st: The measurements of the stage
+ * \param[in]       t0: The start time of the call
+ * \param[in]       points: The number of points of the call (zero for the stages without points)
+ */
+static void account(struct stage *st, double t0, double points)
+{
+	st->calls++;
+	st->seconds += now() - t0;
+	st->points += points;
+}
+
+/**
+ * \brief           Takes the measurements of a stage from the instrumentation of the iterations
+ * \param[out]      st: The measurements of the stage
+ * \param[in]       ss: The structure <stage_stats> of the stage
+ */
+static void stage_copy(struct stage *st, struct stage_stats *ss)
+{
+	st->calls = ss->calls;
+	st->seconds = ss->wall;
+	st->points = ss->points;
+}
+
+/**
+ * \brief           Prints the measurements of the stages, the number of iterations and the
+ * 					errors of the recovered parameters against the true ones
+ * \param[in]       title: The name of the technique
+ * \param[in]       st: The measurements of the stages
+ * \param[in]       x: The recovered parameters
+ * \param[in]       Vx: The variance-covariance matrix of the parameters
+ * \param[in]       truth: The true parameters
+ * \param[in]       c: The number of points
+ * \param[in]       iterations: The number of iterations (of the first group for the sequential adjustments)
+ */
+static void report(const char *title, struct stage *st, type *x, type *Vx, type *truth, long c, int iterations)
+{
+	static const char *par[] = {"tx", "ty", "tz", "ax", "ay", "az", "theta_x", "theta_y", "theta_z"};
+	register int i;
+	type scale, sx;
+	double total = 0.0;
+
+	printf("\n\n%s: c = %ld points, iterations = %d", title, c, iterations);
+	printf("\n%-20s %8s %12s %14s %12s", "stage", "calls", "time [s]", "points/s", "us/call");
+	for (i = 0; i < STAGES; i++)
+		if (st[i].calls > 0)
+		{
+			total += st[i].seconds;
+			printf("\n%-20s %8ld %12.6f", stage_name[i], st[i].calls, st[i].seconds);
+			if (st[i].points > 0.0)
+				printf(" %14.4e", st[i].points / st[i].seconds);
+			else
+				printf(" %14s", "-");
+			printf(" %12.3f", st[i].seconds / st[i].calls * 1e6);
+		}
+	printf("\n%-20s %8s %12.6f %14.4e", "total", "", total, c / total);
+	printf("\n\n%-10s %16s %16s %14s %10s", "parameter", "truth", "estimate", "error", "error/std");
+	for (i = 0; i < 9; i++)
+	{
+		scale = i < 6 ? 1.0L : RDEG;
+		sx = sqrt(Vx[i * 9 + i]);
+		printf("\n%-10s %16.6Lf %16.6Lf %14.3Le %10.2Lf", par[i], truth[i] * scale, x[i] * scale, (x[i] - truth[i]) * scale, (x[i] - truth[i]) / sx);
+	}
+}
+
+/**
+ * \brief           Runs the two fitting techniques (separation in groups and sequential
+ * 					adjustments) as the programs separation_in_groups and sequential_adjustments,
+ * 					and reports the throughput of their stages, the number of iterations and the
+ * 					errors of the recovered parameters against the true parameters of the file
+ * 					name.truth of the program generate_points
+ * \param[in]       argc: The number of arguments that main was called (integer)
+ * \param[in]       argv: The vector of the arguments (string) which contains the options,
+ * 					the file of the true parameters and the names of the data files
+ * \return			An integer value equal to zero
+ */
+int main(int argc, char *argv[])
+{
+	register int i, j;
+	int t, first, iteration, rc;
+	long c = 0, c1;
+	double t0;
+	type truth[9], in_val[9], N_inv[9][9], Vx[9][9];
+	type sigma0ip1;
+	struct stage sep[STAGES], seq[STAGES];
+	struct group *mat;
+	struct solution x, x1;
+	struct ldl f;
+	struct adjustment adj;
+	struct profile prof;
+	struct options opt;
+	double *arena = NULL;
+	FILE *fp;
+
+	/* Reading the options of the command line by calling the function options() */
+	if ((first = options(argc, argv, &opt)) < 0 || (t = argc - first - 1) < 1)
+	{
+		printf("\nUsage: %s [-j threads] [-m] [-c MB] [-s] [-T tol] [-X tol] [-I iterations] [-L halving|lm] name.truth file1.bin [file2.bin ...]\n", argv[0]);
+		exit(1);
+	}
+	if ((fp = fopen(argv[first], "r")) == NULL || fscanf(fp, "%Lf %Lf %Lf %Lf %Lf %Lf %Lf %Lf %Lf", &truth[0], &truth[1], &truth[2], &truth[3], &truth[4], &truth[5], &truth[6], &truth[7], &truth[8]) != 9)
+	{
+		printf("\nCant read the true parameters from the file %s\n", argv[first]);
+		exit(1);
+	}
+	fclose(fp);
+	for (i = 6; i < 9; i++)
+		truth[i] /= RDEG;
+	first++;
+	/* Sorting the names of the data files in alphabetical order */
+	alpha_sort(&argv[first - 1], t + 1);
+	struct data_file files[t];
+	for (i = 0; i < t; i++)
+	{
+		if (open_data(argv[first + i], &files[i], &opt) != 0)
+		{
+			printf("\nCant open the file %s", argv[first + i]);
+			exit(1);
+		}
+		c += files[i].c;
+	}
+	if (opt.cache > 0)
+		arena = load_cache(files, t, (size_t)opt.cache << 20);
+	if ((mat = malloc(t * sizeof(struct group))) == NULL)
+		exit(1);
+	memset(sep, 0, sizeof(sep));
+	memset(seq, 0, sizeof(seq));
+
+	/* Separation in groups */
+	t0 = now();
+	if (initial_values(files, t, &in_val[0], &opt) < 0)
+	{
+		printf("\n\t Error in function Initial values , e = 0\n");
+		exit(1);
+	}
+	account(&sep[0], t0, c);
+	/* The stages of the iterations are measured by the instrumentation of the function iterate_adjustment() */
+	profile_init(&prof, files, t, false);
+	opt.prof = &prof;
+	for (i = 0; i < 9; i++)
+		adj.x[i] = in_val[i];
+	adj.warm = false;
+	if ((rc = iterate_adjustment(files, t, &adj, &opt, mat)) != 0)
+	{
+		printf((rc == -1) ? "\nNot enough memory for the tasks of the scheduler" : "\nThe normal matrix is not positive definite");
+		exit(1);
+	}
+	opt.prof = NULL;
+	stage_copy(&sep[1], &prof.stage[PROF_DIRECT]);
+	stage_copy(&sep[2], &prof.stage[PROF_SUMMARY]);
+	stage_copy(&sep[3], &prof.stage[PROF_SOLVE]);
+	profile_free(&prof);
+	t0 = now();
+	ldl_inverse(&adj.f, &N_inv[0][0], true);
+	account(&sep[3], t0, 0);
+	for (i = 0; i < 9; i++)
+		for (j = 0; j < 9; j++)
+			Vx[i][j] = adj.sigma0ip1 * adj.sigma0ip1 * N_inv[i][j];
+	report("Separation in groups", sep, &adj.x[0], &Vx[0][0], &truth[0], c, adj.iteration);
+
+	/* Sequential adjustments (least squares, the robust kernels are used only by the separation in groups) */
+	opt.robust = ROBUST_NONE;
+	opt.scale = 0.0L;
+	t0 = now();
+	if ((c1 = initial_values(files, 1, &in_val[0], &opt)) < 0)
+	{
+		printf("\n\t Error in function Initial values , e = 0\n");
+		exit(1);
+	}
+	account(&seq[0], t0, c1);
+	t0 = now();
+	x1 = first_solution(&files[0], &in_val[0], &opt, &iteration, &sigma0ip1);
+	account(&seq[4], t0, (double)c1 * iteration);
+	for (i = 1, x = x1; i < t; i++)
+	{
+		t0 = now();
+		x = sequential(&files[i], 1, x1, &opt, NULL);
+		account(&seq[5], t0, files[i].c);
+		x1 = x;
+	}
+	t0 = now();
+	ldl_factor(&x.Nbar[0], &f);
+	ldl_inverse(&f, &N_inv[0][0], true);
+	account(&seq[3], t0, 0);
+	for (i = 0; i < 9; i++)
+		for (j = 0; j < 9; j++)
+			Vx[i][j] = x.s02 * N_inv[i][j];
+	report("Sequential adjustments", seq, &x.x[0], &Vx[0][0], &truth[0], c, iteration);
+	printf("\n");
+	for (i = 0; i < t; i++)
+		close_data(&files[i]);
+	free(arena);
+	free(mat);
+	return 0;
+}
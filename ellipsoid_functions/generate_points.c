@@ -0,0 +1,263 @@
+/**
+ * \file		generate_points.c
+ * \brief       Generation of synthetic data files of a known ellipsoid
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+#define CHUNK 1048576 /* Number of points of a unit of work of the generation */
+
+/* A structure for the description of the synthetic points */
+struct synthetic {
+	type x[9]; /* The true parameters (angles in rad) */
+	type R[3][3]; /* The rotation matrix of the parameters */
+	double noise; /* Standard deviation of the coordinates of the points of unit weight [m] */
+	double wmin, wmax; /* Range of the (uniform) weights */
+	double outliers; /* Rate of the outliers */
+	unsigned long long seed;
+	int groups;
+	long points;
+	int *fd; /* The opened data files of the groups */
+	long per_chunk; /* Number of chunks of every group */
+	long chunks;
+	long next;
+	pthread_mutex_t lock;
+};
+
+/**
+ * \brief           The generator SplitMix64: gives the next pseudo-random number of a state
+ * \param[in,out]   s: The state
+ * \return			A pseudo-random 64-bit number
+ */
+static unsigned long long splitmix(unsigned long long *s)
+{
+	unsigned long long z = (*s += 0x9E3779B97F4A7C15ULL);
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/**
+ * \brief           A pseudo-random number, uniform in (0, 1)
+ * \param[in,out]   s: The state of the generator
+ * \return			The number
+ */
+static double uniform(unsigned long long *s)
+{
+	return ((splitmix(s) >> 11) + 0.5) / 9007199254740992.0;
+}
+
+/**
+ * \brief           A pseudo-random number of the standard normal distribution (Box-Muller)
+ * \param[in,out]   s: The state of the generator
+ * \return			The number
+ */
+static double normal(unsigned long long *s)
+{
+	return sqrt(-2.0 * log(uniform(s))) * cos(2.0 * M_PI * uniform(s));
+}
+
+/**
+ * \brief           Generates the chunks of points until all of them are written. Every chunk
+ * 					has its own generator, so the files do not depend on the number of threads
+ * \param[in]       arg: A pointer to the structure <synthetic>
+ * \return			A null pointer
+ */
+static void *generate(void *arg)
+{
+	struct synthetic *sy = arg;
+	struct cart_coord *buf;
+	unsigned long long s;
+	long k, n, i, first, size_g;
+	double u, v, q[3], w, f;
+	int g;
+	size_t done, size;
+	ssize_t got;
+
+	if ((buf = malloc(CHUNK * sizeof(struct cart_coord))) == NULL)
+		return NULL;
+	for (;;)
+	{
+		pthread_mutex_lock(&sy->lock);
+		k = sy->next++;
+		pthread_mutex_unlock(&sy->lock);
+		if (k >= sy->chunks)
+			break;
+		/* The chunk k is the part of the points of the group g which starts from first */
+		g = k / sy->per_chunk;
+		first = (k % sy->per_chunk) * CHUNK;
+		size_g = sy->points / sy->groups + (g < sy->points % sy->groups);
+		if ((n = (size_g - first < CHUNK) ? size_g - first : CHUNK) <= 0)
+			continue;
+		s = sy->seed ^ (0x9E3779B97F4A7C15ULL * (unsigned long long)(k + 1));
+		for (i = 0; i < n; i++)
+		{
+			/* A point of the surface, in the system of the axes of the ellipsoid */
+			u = 2.0 * M_PI * uniform(&s);
+			v = acos(2.0 * uniform(&s) - 1.0);
+			q[0] = sy->x[3] * sin(v) * cos(u);
+			q[1] = sy->x[4] * sin(v) * sin(u);
+			q[2] = sy->x[5] * cos(v);
+			w = sy->wmin + (sy->wmax - sy->wmin) * uniform(&s);
+			/* The outliers are moved along the radius, by up to half of their distance from the centre */
+			f = (uniform(&s) < sy->outliers) ? 1.0 + (uniform(&s) - 0.5) : 1.0;
+			buf[i].x = sy->x[0] + f * (q[0] * sy->R[0][0] + q[1] * sy->R[1][0] + q[2] * sy->R[2][0]);
+			buf[i].y = sy->x[1] + f * (q[0] * sy->R[0][1] + q[1] * sy->R[1][1] + q[2] * sy->R[2][1]);
+			buf[i].z = sy->x[2] + f * (q[0] * sy->R[0][2] + q[1] * sy->R[1][2] + q[2] * sy->R[2][2]);
+			/* The noise of the coordinates corresponds to the weight of the point */
+			if (sy->noise > 0.0)
+			{
+				buf[i].x += sy->noise / sqrt(w) * normal(&s);
+				buf[i].y += sy->noise / sqrt(w) * normal(&s);
+				buf[i].z += sy->noise / sqrt(w) * normal(&s);
+			}
+			buf[i].w = w;
+		}
+		size = n * sizeof(struct cart_coord);
+		for (done = 0; done < size; done += got)
+			if ((got = pwrite(sy->fd[g], (char *)buf + done, size - done, first * sizeof(struct cart_coord) + done)) <= 0)
+			{
+				printf("\nCant write the group %d", g + 1);
+				exit(1);
+			}
+	}
+	free(buf);
+	return NULL;
+}
+
+/**
+ * \brief           Generates the points of a known triaxial ellipsoid, with noise, weights
+ * 					and outliers, and writes them to a number of data files (binary files)
+ * 					name01.bin, name02.bin, ... The true parameters are written to the text
+ * 					file name.truth, which is read by the program fit_bench
+ * \param[in]       argc: The number of arguments that main was called (integer)
+ * \param[in]       argv: The vector of arguments (string) which contains the options,
+ * 					the name of the files, the number of points, the number of groups, the
+ * 					parameters tx,ty,tz,ax,ay,az,theta_x,theta_y,theta_z ([m] and [deg]) and,
+ * 					optionally, the noise [m], the range of the weights (wmin:wmax), the rate
+ * 					of the outliers and the seed
+ * \return			An integer value equal to zero
+ */
+int main(int argc, char *argv[])
+{
+	int first, digits;
+	register int i;
+	char name[4096];
+	double seconds;
+	type sinx, cosx, siny, cosy, sinz, cosz;
+	struct synthetic sy;
+	struct options opt;
+	struct timespec t0, t1;
+	FILE *fp;
+
+	if ((first = options(argc, argv, &opt)) < 0 || argc - first < 4 || argc - first > 8)
+	{
+		printf("\nUsage: %s [-j threads] name points groups tx,ty,tz,ax,ay,az,theta_x,theta_y,theta_z [noise [wmin:wmax [outliers [seed]]]]\n", argv[0]);
+		exit(1);
+	}
+	sy.points = atol(argv[first + 1]);
+	sy.groups = atoi(argv[first + 2]);
+	sy.noise = argc - first > 4 ? atof(argv[first + 4]) : 0.0;
+	sy.wmin = sy.wmax = 1.0;
+	if (argc - first > 5 && sscanf(argv[first + 5], "%lf:%lf", &sy.wmin, &sy.wmax) == 1)
+		sy.wmax = sy.wmin;
+	sy.outliers = argc - first > 6 ? atof(argv[first + 6]) : 0.0;
+	sy.seed = argc - first > 7 ? strtoull(argv[first + 7], NULL, 10) : 1;
+	if (sscanf(argv[first + 3], "%Lf,%Lf,%Lf,%Lf,%Lf,%Lf,%Lf,%Lf,%Lf", &sy.x[0], &sy.x[1], &sy.x[2], &sy.x[3], &sy.x[4], &sy.x[5], &sy.x[6], &sy.x[7], &sy.x[8]) != 9
+		|| sy.groups < 1 || sy.points < sy.groups || sy.x[3] <= 0.0L || sy.x[4] <= 0.0L || sy.x[5] <= 0.0L
+		|| sy.noise < 0.0 || sy.wmin <= 0.0 || sy.wmax < sy.wmin || sy.outliers < 0.0 || sy.outliers > 1.0)
+	{
+		printf("\nInvalid parameters of the points\n");
+		exit(1);
+	}
+	for (i = 6; i < 9; i++)
+		sy.x[i] /= RDEG;
+	/* The rotation matrix, as in the function model_coefficients() */
+	sinx = sin(sy.x[6]);
+	siny = sin(sy.x[7]);
+	sinz = sin(sy.x[8]);
+	cosx = cos(sy.x[6]);
+	cosy = cos(sy.x[7]);
+	cosz = cos(sy.x[8]);
+	sy.R[0][0] = cosy * cosz;
+	sy.R[0][1] = cosx * sinz + sinx * siny * cosz;
+	sy.R[0][2] = sinx * sinz - cosx * siny * cosz;
+	sy.R[1][0] = -cosy * sinz;
+	sy.R[1][1] = cosx * cosz - sinx * siny * sinz;
+	sy.R[1][2] = sinx * cosz + cosx * siny * sinz;
+	sy.R[2][0] = siny;
+	sy.R[2][1] = -sinx * cosy;
+	sy.R[2][2] = cosx * cosy;
+	/* Creating the data files of the groups (name01.bin, ...) */
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (digits = 2, i = 100; i <= sy.groups; i *= 10)
+		digits++;
+	if ((sy.fd = malloc(sy.groups * sizeof(int))) == NULL)
+		exit(1);
+	for (i = 0; i < sy.groups; i++)
+	{
+		if (snprintf(name, sizeof(name), "%s%0*d.bin", argv[first], digits, i + 1) >= (int)sizeof(name)
+			|| (sy.fd[i] = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0)
+		{
+			printf("\nCant create the file %s\n", name);
+			exit(1);
+		}
+	}
+	/* Every group (of points / groups points, plus one for the first ones) is split into chunks, which are generated by the threads */
+	sy.per_chunk = (sy.points / sy.groups + 1 + CHUNK - 1) / CHUNK;
+	sy.chunks = sy.per_chunk * sy.groups;
+	sy.next = 0;
+	pthread_mutex_init(&sy.lock, NULL);
+	{
+		pthread_t tid[opt.threads];
+		bool started[opt.threads];
+
+		for (i = 0; i < opt.threads; i++)
+			started[i] = i > 0 && pthread_create(&tid[i], NULL, generate, &sy) == 0;
+		/* The calling thread is the worker 0 */
+		generate(&sy);
+		for (i = 1; i < opt.threads; i++)
+			if (started[i])
+				pthread_join(tid[i], NULL);
+	}
+	pthread_mutex_destroy(&sy.lock);
+	for (i = 0; i < sy.groups; i++)
+		close(sy.fd[i]);
+	free(sy.fd);
+	/* Writing the true parameters */
+	if (snprintf(name, sizeof(name), "%s.truth", argv[first]) >= (int)sizeof(name) || (fp = fopen(name, "w")) == NULL)
+	{
+		printf("\nCant create the file %s\n", name);
+		exit(1);
+	}
+	for (i = 0; i < 9; i++)
+		fprintf(fp, "%.10Lf ", sy.x[i] * (i < 6 ? 1.0L : RDEG));
+	fprintf(fp, "\n# tx ty tz ax ay az [m] theta_x theta_y theta_z [deg]\n");
+	fprintf(fp, "# points %ld groups %d noise %g weights %g:%g outliers %g seed %llu\n", sy.points, sy.groups, sy.noise, sy.wmin, sy.wmax, sy.outliers, sy.seed);
+	fclose(fp);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+	printf("\n%ld points in %d groups (%s%0*d.bin, ...), %.3f [s], %.1f Mpoints/s\n", sy.points, sy.groups, argv[first], digits, 1, seconds, sy.points / seconds * 1e-6);
+	return 0;
+}
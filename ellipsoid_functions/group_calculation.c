@@ -0,0 +1,222 @@
+/**
+ * \file		group_calculation.c
+ * \brief       Work-stealing scheduler for the calculation of all the groups
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/* A structure for a task: a range of points of a data file */
+struct task {
+	int file;
+	long first;
+	long n;
+};
+
+/* A structure for the double-ended queue of the tasks of a worker */
+struct deque {
+	pthread_mutex_t lock;
+	int *item;
+	int top;
+	int bottom;
+};
+
+/* A structure for the state which is shared by all the workers */
+struct pool {
+	struct data_file *df;
+	struct model *md;
+	struct task *tasks;
+	struct group *parts;
+	struct deque *dq;
+	int workers;
+};
+
+/* A structure for the arguments of a worker thread */
+struct worker {
+	struct pool *pl;
+	int id;
+};
+
+/**
+ * \brief           Takes a task from a deque. The owner of the deque takes the
+ * 					most recent task (bottom) and the other workers steal the
+ * 					oldest one (top)
+ * \param[in]       dq: The deque
+ * \param[in]       owner: True if the caller is the owner of the deque
+ * \return			The index of the task, or -1 if the deque is empty
+ */
+static int take(struct deque *dq, bool owner)
+{
+	int k = -1;
+
+	pthread_mutex_lock(&dq->lock);
+	if (dq->top < dq->bottom)
+		k = owner ? dq->item[--dq->bottom] : dq->item[dq->top++];
+	pthread_mutex_unlock(&dq->lock);
+	return k;
+}
+
+/**
+ * \brief           Executes the tasks of its own deque and, when it is empty,
+ * 					steals tasks from the deques of the other workers
+ * \param[in]       arg: A pointer to the structure <worker> of the thread
+ * \return			A null pointer
+ */
+static void *work(void *arg)
+{
+	struct worker *wk = arg;
+	struct pool *pl = wk->pl;
+	struct cart_coord buf[BLOCK];
+	struct span sp;
+	struct task *tk;
+	register int v;
+	int k;
+	long i, n;
+
+	for (;;)
+	{
+		if ((k = take(&pl->dq[wk->id], true)) < 0)
+			/* Stealing from the other workers, starting from the next one */
+			for (v = 1; v < pl->workers && k < 0; v++)
+				k = take(&pl->dq[(wk->id + v) % pl->workers], false);
+		if (k < 0)
+			return NULL; /* No new tasks are created, so all the work is taken */
+		tk = &pl->tasks[k];
+		for (i = 0; i < tk->n; i += n)
+		{
+			if ((n = fetch_points(&pl->df[tk->file], tk->first + i, tk->n - i, buf, &sp)) <= 0)
+				break;
+			pl->md->kernel(&sp, pl->md, &pl->parts[k]);
+		}
+	}
+}
+
+/**
+ * \brief           Calculates the structure <group> of every data file with a pool
+ * 					of threads. The files are split into tasks (ranges of points) of
+ * 					similar size, which are dealt to per-worker deques. Idle workers
+ * 					steal tasks from the others, so that a few large files do not keep
+ * 					the rest of the threads waiting. The contributions of the tasks of
+ * 					each file are added in their order, so the result does not depend
+ * 					on the scheduling
+ * \param[in]       df: Vector of the structures <data_file> of the data files
+ * \param[in]       t: Number of the data files
+ * \param[in]       values: Vector of the current values of the triaxial ellipsoid
+ * \param[in]       opt: The run-time options (threads and kernel)
+ * \param[out]      mat: Vector of the structures <group> of the data files
+ * \return			Zero, or -1 if there is not enough memory for the tasks
+ */
+int group_calculation(struct data_file *df, int t, type *values, struct options *opt, struct group *mat)
+{
+	register int i, j;
+	int ntasks = 0, *items, threads = opt->threads;
+	long total = 0, chunk, first;
+	struct model md;
+	struct task *tasks;
+	struct group *parts;
+	struct pool pl;
+
+	model_coefficients(values, &md);
+	select_kernel(&md, opt);
+	for (i = 0; i < t; i++)
+		total += df[i].c;
+	/* Several tasks per thread, but not smaller than MINRANGE points */
+	chunk = total / threads / 8;
+	if (chunk < MINRANGE)
+		chunk = MINRANGE;
+	for (i = 0; i < t; i++)
+		ntasks += (df[i].c + chunk - 1) / chunk;
+	tasks = malloc(ntasks * sizeof(struct task));
+	parts = malloc(ntasks * sizeof(struct group));
+	items = malloc(ntasks * sizeof(int));
+	pl.dq = malloc(threads * sizeof(struct deque));
+	if (tasks == NULL || parts == NULL || items == NULL || pl.dq == NULL)
+	{
+		free(tasks);
+		free(parts);
+		free(items);
+		free(pl.dq);
+		return -1;
+	}
+	/* Splitting the files into tasks */
+	ntasks = 0;
+	for (i = 0; i < t; i++)
+		for (first = 0; first < df[i].c; first += chunk, ntasks++)
+		{
+			tasks[ntasks].file = i;
+			tasks[ntasks].first = first;
+			tasks[ntasks].n = (df[i].c - first < chunk) ? df[i].c - first : chunk;
+			zeros(&parts[ntasks].N_bar[0], NPACK, 1);
+			zeros(&parts[ntasks].U_bar[0], 9, 1);
+			parts[ntasks].sum_piwi2 = 0.0L;
+			parts[ntasks].weight = 0.0L;
+			parts[ntasks].c = 0;
+		}
+	/* Dealing consecutive tasks to the deques of the workers */
+	for (i = 0; i < threads; i++)
+	{
+		pthread_mutex_init(&pl.dq[i].lock, NULL);
+		pl.dq[i].item = &items[(long)ntasks * i / threads];
+		pl.dq[i].top = 0;
+		pl.dq[i].bottom = (long)ntasks * (i + 1) / threads - (long)ntasks * i / threads;
+		/* The owner starts from the bottom, so the tasks are stored in reverse order */
+		for (j = 0; j < pl.dq[i].bottom; j++)
+			pl.dq[i].item[j] = (long)ntasks * (i + 1) / threads - 1 - j;
+	}
+	pl.df = df;
+	pl.md = &md;
+	pl.tasks = tasks;
+	pl.parts = parts;
+	pl.workers = threads;
+	{
+		pthread_t tid[threads];
+		bool started[threads];
+		struct worker wk[threads];
+
+		for (i = 0; i < threads; i++)
+		{
+			wk[i].pl = &pl;
+			wk[i].id = i;
+			started[i] = i > 0 && pthread_create(&tid[i], NULL, work, &wk[i]) == 0;
+		}
+		/* The calling thread is the worker 0 */
+		work(&wk[0]);
+		for (i = 1; i < threads; i++)
+			if (started[i])
+				pthread_join(tid[i], NULL);
+	}
+	/* Adding the contributions of the tasks of each file */
+	for (i = 0, j = 0; i < t; i++)
+	{
+		first = j;
+		while (j < ntasks && tasks[j].file == i)
+			j++;
+		mat[i] = summary(&parts[first], j - first);
+	}
+	for (i = 0; i < threads; i++)
+		pthread_mutex_destroy(&pl.dq[i].lock);
+	free(pl.dq);
+	free(items);
+	free(parts);
+	free(tasks);
+	return 0;
+}
@@ -0,0 +1,310 @@
+/**
+ * \file		group_coordinator.c
+ * \brief       Coordinator of the distributed fitting: merging of the contributions of the shards
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/* A structure for the links with the workers: their sockets or the shared directory */
+struct links {
+	int workers;
+	int *fd; /* The connected sockets of the workers, or a null pointer */
+	char *dir; /* The shared directory, or a null pointer */
+};
+
+/**
+ * \brief           Writes the request of the coordinator into the shared directory (file
+ * 					request.grp), with a temporary name which is renamed
+ * \param[in]       dir: The shared directory
+ * \param[in]       req: The request
+ * \return			Zero on success, or -1 if the file cannot be written
+ */
+static int write_request(char *dir, struct group_record *req)
+{
+	int fd, rc;
+	char tmp[strlen(dir) + 16], path[strlen(dir) + 16];
+
+	sprintf(tmp, "%s/.request.tmp", dir);
+	sprintf(path, "%s/request.grp", dir);
+	if ((fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0)
+		return -1;
+	rc = send_group(fd, req);
+	if (rc != 0 || fsync(fd) != 0 || close(fd) != 0 || rename(tmp, path) != 0)
+	{
+		if (rc != 0)
+			close(fd);
+		remove(tmp);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * \brief           Collects the answers of the workers to a request from the shared
+ * 					directory: the files shard-N.grp of the same fit, iteration and kind,
+ * 					one from every shard
+ * \param[in]       ln: The links with the workers
+ * \param[in]       req: The request
+ * \param[out]      ans: Vector of the answers of the workers
+ */
+static void collect_answers(struct links *ln, struct group_record *req, struct group_record *ans)
+{
+	register int i;
+	int n = 0, fd;
+	DIR *dp;
+	struct dirent *de;
+	struct group_record rec;
+	char path[strlen(ln->dir) + 300];
+
+	while (n < ln->workers)
+	{
+		if ((dp = opendir(ln->dir)) != NULL)
+		{
+			while (n < ln->workers && (de = readdir(dp)) != NULL)
+			{
+				if (strncmp(de->d_name, "shard-", 6) != 0 || strlen(de->d_name) > 256)
+					continue;
+				sprintf(path, "%s/%s", ln->dir, de->d_name);
+				if ((fd = open(path, O_RDONLY)) < 0)
+					continue;
+				if (recv_group(fd, &rec) == 0 && rec.run == req->run && rec.iteration == req->iteration && rec.kind == req->kind)
+				{
+					for (i = 0; i < n && ans[i].shard != rec.shard; i++);
+					if (i == n)
+						ans[n++] = rec;
+				}
+				close(fd);
+			}
+			closedir(dp);
+		}
+		if (n < ln->workers)
+			usleep(GROUP_POLL * 1000);
+	}
+}
+
+/**
+ * \brief           Sends a request to all the workers and collects their answers (the
+ * 					stop of the fit has no answers)
+ * \param[in]       ln: The links with the workers
+ * \param[in]       req: The request
+ * \param[out]      ans: Vector of the answers of the workers
+ */
+static void exchange(struct links *ln, struct group_record *req, struct group_record *ans)
+{
+	register int i;
+
+	if (ln->dir != NULL)
+	{
+		if (write_request(ln->dir, req) != 0)
+		{
+			printf("\nCant write the request into the directory %s\n", ln->dir);
+			exit(1);
+		}
+		if (req->kind != REC_STOP)
+			collect_answers(ln, req, ans);
+		return;
+	}
+	/* The workers calculate their contributions concurrently */
+	for (i = 0; i < ln->workers; i++)
+		if (send_group(ln->fd[i], req) != 0 && req->kind != REC_STOP)
+		{
+			printf("\nCant send the request to the worker %d\n", i + 1);
+			exit(1);
+		}
+	if (req->kind != REC_STOP)
+		for (i = 0; i < ln->workers; i++)
+			if (recv_group(ln->fd[i], &ans[i]) != 0 || ans[i].run != req->run || ans[i].iteration != req->iteration || ans[i].kind != req->kind)
+			{
+				printf("\nInvalid answer of the worker %d to the iteration %d\n", i + 1, req->iteration);
+				exit(1);
+			}
+}
+
+/**
+ * \brief           Fitting a triaxial ellipsoid by applying the separation in groups technique
+ * 					to the points of several workers (program group_worker), e.g. on several
+ * 					nodes, without moving the points. The coordinator sends the parameters of
+ * 					every iteration to the workers, merges their contributions (N, u) and
+ * 					solves for the corrections; the initial values are given by the moment
+ * 					sums of the workers. The links are a Unix socket (-U), where the workers
+ * 					connect, or a shared directory (-D)
+ * \param[in]       argc: The number of arguments that main was called (integer)
+ * \param[in]       argv: The vector of arguments (string) which
+ * 					contains the options and the number of the workers
+ * \return			An integer value equal to zero
+ */
+int main(int argc, char *argv[])
+{
+	register int i, j;
+	int first, k, rc, listen_fd = -1;
+	long c, n, m, r;
+	type in_val[9], N_inv[9][9], Vx[9][9];
+	struct moments mom;
+	struct adjustment adj;
+	struct options opt;
+	struct links ln;
+	struct group_record req;
+	struct sockaddr_un addr;
+	double start = clock_seconds(CLOCK_MONOTONIC), wait = 0.0, t0;
+
+	/* Reading the options of the command line by calling the function options() */
+	if ((first = options(argc, argv, &opt)) < 0 || argc - first != 1 || (k = atoi(argv[first])) < 1 || (opt.socket == NULL) == (opt.spool == NULL))
+	{
+		printf("\nUsage: %s [-T tol] [-X tol] [-I iterations] [-L halving|lm] [-r huber|tukey[:k]] (-U socket | -D dir) workers\n", argv[0]);
+		exit(1);
+	}
+	if (opt.ransac > 0)
+	{
+		printf("\nThe RANSAC pre-fit (-A) is not available in the distributed fitting\n");
+		exit(1);
+	}
+	int fds[k];
+	struct group_record ans[k];
+	struct group mat[k];
+	signal(SIGPIPE, SIG_IGN);
+	ln.workers = k;
+	ln.fd = NULL;
+	ln.dir = opt.spool;
+	/* Waiting for the workers at the Unix socket */
+	if (opt.socket != NULL)
+	{
+		memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		if (strlen(opt.socket) >= sizeof(addr.sun_path) || (listen_fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+		{
+			printf("\nCant create the socket %s\n", opt.socket);
+			exit(1);
+		}
+		strcpy(addr.sun_path, opt.socket);
+		unlink(opt.socket);
+		if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_fd, k) != 0)
+		{
+			printf("\nCant create the socket %s\n", opt.socket);
+			exit(1);
+		}
+		for (i = 0; i < k; i++)
+			if ((fds[i] = accept(listen_fd, NULL, NULL)) < 0)
+			{
+				printf("\nCant accept the worker %d\n", i + 1);
+				exit(1);
+			}
+		ln.fd = fds;
+	}
+	/* Every fit has its own identifier, so that the answers of a previous fit are not used */
+	memset(&req, 0, sizeof(req));
+	req.run = ((unsigned long long)getpid() << 32) ^ (unsigned long long)(clock_seconds(CLOCK_REALTIME) * 1e6);
+	/* Calculating the initial values from the moment sums of the workers */
+	t0 = clock_seconds(CLOCK_MONOTONIC);
+	req.kind = REC_MOMENTS;
+	exchange(&ln, &req, ans);
+	wait += clock_seconds(CLOCK_MONOTONIC) - t0;
+	mom.c = 0;
+	for (j = 0; j < 34; j++)
+		mom.a[j] = 0.0L;
+	for (i = 0; i < k; i++)
+	{
+		for (j = 0; j < 34; j++)
+			mom.a[j] += ans[i].mom.a[j];
+		mom.c += ans[i].mom.c;
+	}
+	if (algebraic_fit(&mom, &in_val[0]) != 0)
+	{
+		printf("\n\t Error in function Initial values , e = 0\n");
+		exit(1);
+	}
+	c = mom.c;
+	/* Printing the initial values of the triaxial ellipsoid */
+	display(&in_val[0], 9, 1, 4, "Initial Values");
+	n = 3 * c; /* Total number of measurements */
+	m = 9 + 2 * c; /* Total number of unknowns */
+	r = n - m; /* Degrees of freedom */
+	for (i = 0; i < 9; i++)
+		adj.x[i] = in_val[i];
+	adj.iteration = 0;
+	adj.warm = false;
+	req.kind = REC_GROUP;
+	req.robust = opt.robust;
+	req.tuning = opt.tuning;
+	/* Iterative adjustment procedure: the workers calculate the contributions of their shards */
+	do {
+		req.iteration = adj.iteration + 1;
+		for (i = 0; i < 9; i++)
+			req.values[i] = adj.x[i];
+		req.scale = opt.scale;
+		t0 = clock_seconds(CLOCK_MONOTONIC);
+		exchange(&ln, &req, ans);
+		wait += clock_seconds(CLOCK_MONOTONIC) - t0;
+		for (i = 0; i < k; i++)
+			mat[i] = ans[i].g;
+		adj.g = summary(mat, k);
+		/* Completing the iteration by calling the function adjustment_step() */
+	} while ((rc = adjustment_step(&adj, &opt)) == 0);
+	/* Stopping the workers */
+	req.kind = REC_STOP;
+	req.iteration = adj.iteration + 1;
+	exchange(&ln, &req, ans);
+	if (listen_fd >= 0)
+	{
+		for (i = 0; i < k; i++)
+			close(fds[i]);
+		close(listen_fd);
+		unlink(opt.socket);
+	}
+	if (rc < 0)
+	{
+		printf("\nThe normal matrix is not positive definite\n");
+		exit(1);
+	}
+	
+	/* Calculating the variance-covariance matrix from the factorization of the last iteration */
+	ldl_inverse(&adj.f, &N_inv[0][0], true);
+	for (i = 0; i < 9; i++)
+		for (j = 0; j < 9; j++)
+			Vx[i][j] = adj.sigma0ip1 * adj.sigma0ip1 * N_inv[i][j];
+	
+	/* Printing results */
+	printf("\nNumber of workers = %d", k);
+	printf("\n\nc = %ld points", c);
+	printf("\nn = %ld measurements", n);
+	printf("\nm = %ld unknowns", m);
+	printf("\nr = %ld degrees of freedom", r);
+	if (opt.robust != ROBUST_NONE)
+		printf("\nEffective r = %.1Lf degrees of freedom (%s weights, k = %.3Lf)", adj.g.weight - 9, opt.robust == ROBUST_HUBER ? "Huber" : "Tukey", opt.tuning);
+	printf("\nIterations = %d", adj.iteration);
+	if (opt.damping != DAMP_NONE)
+		printf(" (%d rejected steps)", adj.dm.rejected);
+	printf("\nExecution time = %.3f [s] (wall), %.3f [s] waiting for the workers", clock_seconds(CLOCK_MONOTONIC) - start, wait);
+	printf("\n\nElipsoid Parameters:");
+	printf("\ntx = %-.4Lf +/- %-.5Lf [m]", adj.x[0], (type)sqrt(Vx[0][0]));
+	printf("\nty = %-.4Lf +/- %-.5Lf [m]", adj.x[1], (type)sqrt(Vx[1][1]));
+	printf("\ntz = %-.4Lf +/- %-.5Lf [m]", adj.x[2], (type)sqrt(Vx[2][2]));
+	printf("\nax = %-.4Lf +/- %-.5Lf [m]", adj.x[3], (type)sqrt(Vx[3][3]));
+	printf("\nay = %-.4Lf +/- %-.5Lf [m]", adj.x[4], (type)sqrt(Vx[4][4]));
+	printf("\naz = %-.4Lf +/- %-.5Lf [m]", adj.x[5], (type)sqrt(Vx[5][5]));
+	printf("\ntheta_x = %-.4Lf +/- %-.5Lf [deg]", adj.x[6] * RDEG, (type)sqrt(Vx[6][6]) * RDEG);
+	printf("\ntheta_y = %-.4Lf +/- %-.5Lf [deg]", adj.x[7] * RDEG, (type)sqrt(Vx[7][7]) * RDEG);
+	printf("\ntheta_z = %-.4Lf +/- %-.5Lf [deg]", adj.x[8] * RDEG, (type)sqrt(Vx[8][8]) * RDEG);
+	printf("\ns0_aposteriori = +/- %-.4Lf [m]", adj.sigma0ip1);
+	display(&Vx[0][0], 9, 9, 7, "Vx");
+	return 0;
+}
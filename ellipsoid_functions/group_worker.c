@@ -0,0 +1,222 @@
+/**
+ * \file		group_worker.c
+ * \brief       Worker of the distributed fitting: the contributions of a shard of data files
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+static volatile sig_atomic_t quit = 0;
+
+/**
+ * \brief           Stops the worker at SIGINT or SIGTERM
+ * \param[in]       sig: The number of the signal
+ */
+static void stop_signal(int sig)
+{
+	(void)sig;
+	quit = 1;
+}
+
+/**
+ * \brief           Waits for the next request of the coordinator in the shared directory:
+ * 					the file request.grp, whose fit or iteration differs from the last one
+ * \param[in]       dir: The shared directory
+ * \param[out]      req: The request
+ * \param[in]       last: The last request which was answered
+ * \return			Zero, or -1 if the worker is stopped by a signal
+ */
+static int wait_request(char *dir, struct group_record *req, struct group_record *last)
+{
+	int fd, rc;
+	char path[strlen(dir) + 16];
+
+	sprintf(path, "%s/request.grp", dir);
+	while (!quit)
+	{
+		if ((fd = open(path, O_RDONLY)) >= 0)
+		{
+			rc = recv_group(fd, req);
+			close(fd);
+			if (rc == 0 && (req->run != last->run || req->iteration != last->iteration || req->kind != last->kind))
+				return 0;
+		}
+		usleep(GROUP_POLL * 1000);
+	}
+	return -1;
+}
+
+/**
+ * \brief           Writes the answer of the worker into the shared directory (file
+ * 					shard-N.grp), with a temporary name which is renamed, so that the
+ * 					coordinator never reads an incomplete record
+ * \param[in]       dir: The shared directory
+ * \param[in]       ans: The answer
+ * \return			Zero on success, or -1 if the file cannot be written
+ */
+static int write_answer(char *dir, struct group_record *ans)
+{
+	int fd, rc;
+	char tmp[strlen(dir) + 32], path[strlen(dir) + 32];
+
+	sprintf(tmp, "%s/.shard-%d.tmp", dir, ans->shard);
+	sprintf(path, "%s/shard-%d.grp", dir, ans->shard);
+	if ((fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0)
+		return -1;
+	rc = send_group(fd, ans);
+	if (rc != 0 || fsync(fd) != 0 || close(fd) != 0 || rename(tmp, path) != 0)
+	{
+		if (rc != 0)
+			close(fd);
+		remove(tmp);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * \brief           Serves the requests of the coordinator of the distributed fitting for a
+ * 					shard of data files, which are opened (and cached) once: the moment sums
+ * 					of the points (initial values) and the contribution (N, u) of the points
+ * 					at the parameters of every iteration, until the end of the fit. The
+ * 					requests and the answers are exchanged through a Unix socket of the
+ * 					coordinator (-U) or through a shared directory (-D), so that the points
+ * 					are never moved
+ * \param[in]       argc: The number of arguments that main was called (integer)
+ * \param[in]       argv: The vector of arguments (string) which contains the options,
+ * 					the number of the shard and the names of the data files
+ * \return			Zero on success, or one on failure
+ */
+int main(int argc, char *argv[])
+{
+	register int i;
+	int first, t, fd = -1, shard, served = 0;
+	struct options opt;
+	struct group_record req, ans, last;
+	struct sockaddr_un addr;
+	struct sigaction sa;
+	double *arena = NULL;
+
+	/* Reading the options of the command line by calling the function options() */
+	if ((first = options(argc, argv, &opt)) < 0 || (t = argc - first - 1) < 1 || (opt.socket == NULL) == (opt.spool == NULL))
+	{
+		printf("\nUsage: %s [-j threads] [-m] [-c MB] [-s] (-U socket | -D dir) shard file1.bin|.txt [file2.bin|.txt ...]\n", argv[0]);
+		exit(1);
+	}
+	shard = atoi(argv[first]);
+	struct data_file files[t];
+	struct group mat[t];
+	/* Data Files control */
+	for (i = 0; i < t; i++)
+	{
+		if (open_data(argv[first + 1 + i], &files[i], &opt) != 0)
+		{
+			printf("\nCant open the file %s\n", argv[first + 1 + i]);
+			exit(1);
+		}
+	}
+	if (opt.cache > 0)
+		arena = load_cache(files, t, (size_t)opt.cache << 20);
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = stop_signal;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	signal(SIGPIPE, SIG_IGN);
+	/* Connecting to the coordinator, which may not have created its socket yet */
+	if (opt.socket != NULL)
+	{
+		memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		if (strlen(opt.socket) >= sizeof(addr.sun_path))
+		{
+			printf("\nInvalid socket %s\n", opt.socket);
+			exit(1);
+		}
+		strcpy(addr.sun_path, opt.socket);
+		while (!quit && ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0))
+		{
+			if (fd >= 0)
+				close(fd);
+			fd = -1;
+			usleep(GROUP_POLL * 1000);
+		}
+	}
+	memset(&last, 0, sizeof(last));
+	memset(&ans, 0, sizeof(ans));
+	while (!quit)
+	{
+		/* Receiving the next request */
+		if (opt.socket != NULL ? recv_group(fd, &req) != 0 : wait_request(opt.spool, &req, &last) != 0)
+			break;
+		last = req;
+		/* A stop of the shared directory ends only a fit of this worker (not the previous one) */
+		if (req.kind == REC_STOP && (opt.socket != NULL || req.run == ans.run))
+			break;
+		if (req.kind == REC_STOP)
+			continue;
+		ans.kind = req.kind;
+		ans.shard = shard;
+		ans.iteration = req.iteration;
+		ans.run = req.run;
+		for (i = 0; i < 9; i++)
+			ans.values[i] = req.values[i];
+		ans.robust = req.robust;
+		ans.tuning = req.tuning;
+		ans.scale = req.scale;
+		if (req.kind == REC_MOMENTS)
+			/* Calculating the moment sums of the shard by calling the function moment_calculation() */
+			moment_calculation(files, t, &ans.mom, &opt);
+		else
+		{
+			/* Calculating the contribution of the shard at the parameters of the coordinator */
+			opt.robust = req.robust;
+			opt.tuning = req.tuning;
+			opt.scale = req.scale;
+			if (opt.threads > 1)
+			{
+				if (group_calculation(files, t, &req.values[0], &opt, mat) != 0)
+				{
+					printf("\nNot enough memory for the tasks of the scheduler\n");
+					exit(1);
+				}
+			}
+			else
+				for (i = 0; i < t; i++)
+					mat[i] = direct_calculation(&files[i], &req.values[0], &opt);
+			ans.g = summary(mat, t);
+		}
+		/* Sending the answer */
+		if (opt.socket != NULL ? send_group(fd, &ans) != 0 : write_answer(opt.spool, &ans) != 0)
+		{
+			printf("\nCant send the answer of the iteration %d\n", req.iteration);
+			exit(1);
+		}
+		served++;
+	}
+	if (fd >= 0)
+		close(fd);
+	for (i = 0; i < t; i++)
+		close_data(&files[i]);
+	free(arena);
+	printf("Shard %d: %d requests served\n", shard, served);
+	return 0;
+}
@@ -0,0 +1,59 @@
+/**
+ * \file		has_converged.c
+ * \brief       Convergence test of the iterations
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Tests the convergence of an iteration: the change of the a-posteriori
+ * 					standard deviation is within the tolerance and (with a step tolerance)
+ * 					every correction is within the step tolerance as well, relative to the
+ * 					largest semi-axis for the translations and the semi-axes and in rad for
+ * 					the angles, so that a flat standard deviation does not stop parameters
+ * 					which still move
+ * \param[in]       sigma0i: The a-posteriori standard deviation of the previous iteration
+ * \param[in]       sigma0ip1: The a-posteriori standard deviation of the iteration
+ * \param[in]       step: Vector of the 9 corrections of the iteration
+ * \param[in]       values: Vector of the 9 corrected parameters
+ * \param[in]       opt: The run-time options (tolerances)
+ * \return			True if the iteration has converged
+ */
+bool has_converged(type sigma0i, type sigma0ip1, type *step, type *values, struct options *opt)
+{
+	register int i;
+	type size = 0.0L, change = MYABS(sigma0i - sigma0ip1);
+
+	if (change > opt->tolerance)
+		return false;
+	/* A standard deviation which is not a number stops the iterations as well */
+	if (isnan(change) || opt->step_tol <= 0.0L)
+		return true;
+	for (i = 3; i < 6; i++)
+		if (MYABS(values[i]) > size)
+			size = MYABS(values[i]);
+	for (i = 0; i < 9; i++)
+		if (MYABS(step[i]) > opt->step_tol * (i < 6 ? size : 1.0L))
+			return false;
+	return true;
+}
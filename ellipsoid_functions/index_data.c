@@ -0,0 +1,79 @@
+/**
+ * \file		index_data.c
+ * \brief       Calculation of the index of a data file
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Reads all the points of a data file and calculates its index, i.e.
+ * 					the number of points, the bounding box, the sum of the weights and
+ * 					the moment sums a1, ..., a34 (by calling the function moment_sums())
+ * \param[in]       df: The structure <data_file> of the file
+ * \param[out]      idx: The structure <point_index> of the file
+ */
+void index_data(struct data_file *df, struct point_index *idx)
+{
+	register int i;
+	long j, k, n;
+	type wsum = 0.0L;
+	struct cart_coord buf[BLOCK];
+	struct span sp;
+	struct moments mom;
+
+	memset(idx, 0, sizeof(struct point_index));
+	memcpy(idx->magic, INDEX_MAGIC, sizeof(idx->magic));
+	idx->version = INDEX_VERSION;
+	idx->record = sizeof(struct cart_coord);
+	for (i = 0; i < 3; i++)
+	{
+		idx->min[i] = INFINITY;
+		idx->max[i] = -INFINITY;
+	}
+	mom.c = 0;
+	for (i = 0; i < 34; i++)
+		mom.a[i] = 0.0L;
+	for (k = 0; (n = fetch_points(df, k, df->c - k, buf, &sp)) > 0; k += n)
+	{
+		moment_sums(&sp, &mom);
+		for (j = 0; j < n; j++)
+		{
+			idx->min[0] = fmin(idx->min[0], sp.x[j * sp.stride]);
+			idx->max[0] = fmax(idx->max[0], sp.x[j * sp.stride]);
+			idx->min[1] = fmin(idx->min[1], sp.y[j * sp.stride]);
+			idx->max[1] = fmax(idx->max[1], sp.y[j * sp.stride]);
+			idx->min[2] = fmin(idx->min[2], sp.z[j * sp.stride]);
+			idx->max[2] = fmax(idx->max[2], sp.z[j * sp.stride]);
+			wsum += sp.w[j * sp.stride];
+		}
+	}
+	/* Splitting the long double sums into pairs of doubles */
+	idx->c = mom.c;
+	idx->w[0] = wsum;
+	idx->w[1] = wsum - idx->w[0];
+	for (i = 0; i < 34; i++)
+	{
+		idx->a[i][0] = mom.a[i];
+		idx->a[i][1] = mom.a[i] - idx->a[i][0];
+	}
+}
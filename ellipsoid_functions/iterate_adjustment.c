@@ -0,0 +1,71 @@
+/**
+ * \file		iterate_adjustment.c
+ * \brief       Iterative least-squares adjustment of the points of data files
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Iterates the least-squares adjustment of all the points of the data files,
+ * 					from the parameters of the state until the iterations end. In every iteration
+ * 					the contributions of the groups are calculated by the threads (function
+ * 					group_calculation()) or one group after the other (function direct_calculation()),
+ * 					summed, and the iteration is completed by the function adjustment_step()
+ * \param[in]       df: Vector of the structures <data_file> of the data files
+ * \param[in]       file_num: The number of the data files
+ * \param[in,out]   adj: The structure <adjustment> of the fit, whose member x contains the
+ * 					initial values and receives the adjusted parameters
+ * \param[in,out]   opt: The run-time options (threads, kernel, step control, tolerances,
+ * 					iterations, weight function and instrumentation)
+ * \param[out]      mat: Vector of the contributions of the groups of the last iteration
+ * \return			Zero on success, -1 if there is not enough memory for the tasks of the
+ * 					scheduler, or -2 if the matrix N is not positive definite
+ */
+int iterate_adjustment(struct data_file *df, int file_num, struct adjustment *adj, struct options *opt, struct group *mat)
+{
+	register int i;
+	int rc;
+	long long points = 0;
+	struct stage_timer tm;
+
+	for (i = 0; i < file_num; i++)
+		points += df[i].c;
+	adj->iteration = 0;
+	do {
+		stage_begin(opt->prof, &tm);
+		if (opt->threads > 1)
+		{
+			/* Sharing the points of all the files among the threads by calling the function group_calculation() */
+			if (group_calculation(df, file_num, &adj->x[0], opt, mat) != 0)
+				return -1;
+		}
+		else
+			for (i = 0; i < file_num; i++)
+				mat[i] = direct_calculation(&df[i], &adj->x[0], opt);
+		stage_end(opt->prof, PROF_DIRECT, &tm, points);
+		stage_begin(opt->prof, &tm);
+		adj->g = summary(mat, file_num);
+		stage_end(opt->prof, PROF_SUMMARY, &tm, 0);
+	} while ((rc = adjustment_step(adj, opt)) == 0);
+	return (rc < 0) ? -2 : 0;
+}
@@ -0,0 +1,67 @@
+/**
+ * \file		ldl_factor.c
+ * \brief       LDL' factorization of a 9x9 matrix
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Factorizes a 9x9 symmetric positive definite matrix as N = L D L',
+ * 					without square roots. The matrix is packed (its upper triangle by rows,
+ * 					NPACK elements). The dimension is fixed, so the loops are fully unrolled
+ * 					by the compiler and the packed indices are constants
+ * \param[in]       N: The packed symmetric matrix
+ * \param[out]      f: The structure <ldl> of the factorization
+ * \return			Zero, or -1 if a pivot is not positive (the matrix is not positive definite)
+ */
+int ldl_factor(type *N, struct ldl *f)
+{
+	register int i, j, k;
+	int rc = 0;
+	type v[9], sum;
+
+#pragma GCC unroll 9
+	for (j = 0; j < 9; j++)
+	{
+		/* Row j of L: v_i = L_ji d_i = N_ij - sum(L_ik v_k, k < i) */
+#pragma GCC unroll 9
+		for (i = 0; i < j; i++)
+		{
+			sum = N[UPPER(i, j)];
+#pragma GCC unroll 9
+			for (k = 0; k < i; k++)
+				sum -= f->L[i][k] * v[k];
+			v[i] = sum;
+			f->L[j][i] = sum * f->dinv[i];
+		}
+		/* The pivot d_j = N_jj - sum(L_jk v_k, k < j) */
+		sum = N[UPPER(j, j)];
+#pragma GCC unroll 9
+		for (k = 0; k < j; k++)
+			sum -= f->L[j][k] * v[k];
+		if (!(sum > 0.0L))
+			rc = -1;
+		f->dinv[j] = 1.0L / sum;
+	}
+	return rc;
+}
@@ -0,0 +1,78 @@
+/**
+ * \file		ldl_inverse.c
+ * \brief       Inverse of a 9x9 matrix from its LDL' factorization
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Calculates the inverse N^-1 = W' D^-1 W (W = L^-1), given the factorization
+ * 					N = L D L' of the function ldl_factor(). The selective form calculates only
+ * 					the diagonal, which gives the standard deviations of the parameters
+ * \param[in]       f: The structure <ldl> of the factorization
+ * \param[out]      Ninv: The inverse matrix (9x9, by rows)
+ * \param[in]       full: True for the whole (symmetric) matrix, false for its diagonal only
+ * 					(the other elements are not changed)
+ */
+void ldl_inverse(struct ldl *f, type *Ninv, bool full)
+{
+	register int i, j, k;
+	type W[9][9], sum;
+
+	/* The unit lower triangular matrix W = L^-1, by columns */
+#pragma GCC unroll 9
+	for (j = 0; j < 9; j++)
+	{
+		W[j][j] = 1.0L;
+#pragma GCC unroll 9
+		for (i = j + 1; i < 9; i++)
+		{
+			sum = -f->L[i][j];
+#pragma GCC unroll 9
+			for (k = j + 1; k < i; k++)
+				sum -= f->L[i][k] * W[k][j];
+			W[i][j] = sum;
+		}
+	}
+	/* The elements (N^-1)_ij = sum(W_ki W_kj / d_k, k >= j) for j >= i */
+#pragma GCC unroll 9
+	for (i = 0; i < 9; i++)
+	{
+		sum = f->dinv[i];
+#pragma GCC unroll 9
+		for (k = i + 1; k < 9; k++)
+			sum += W[k][i] * W[k][i] * f->dinv[k];
+		Ninv[i * 9 + i] = sum;
+		if (!full)
+			continue;
+#pragma GCC unroll 9
+		for (j = i + 1; j < 9; j++)
+		{
+			sum = W[j][i] * f->dinv[j];
+#pragma GCC unroll 9
+			for (k = j + 1; k < 9; k++)
+				sum += W[k][i] * W[k][j] * f->dinv[k];
+			Ninv[i * 9 + j] = Ninv[j * 9 + i] = sum;
+		}
+	}
+}
@@ -0,0 +1,62 @@
+/**
+ * \file		ldl_solve.c
+ * \brief       Solution of a 9x9 system from its LDL' factorization
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Solves the system N x = b, given the factorization N = L D L'
+ * 					of the function ldl_factor(), by forward and back substitution
+ * \param[in]       f: The structure <ldl> of the factorization
+ * \param[in]       b: The right-hand side vector (9)
+ * \param[out]      x: The solution vector (9), which may be the same as b
+ */
+void ldl_solve(struct ldl *f, type *b, type *x)
+{
+	register int i, k;
+	type y[9], sum;
+
+	/* Forward substitution (L y = b) */
+#pragma GCC unroll 9
+	for (i = 0; i < 9; i++)
+	{
+		sum = b[i];
+#pragma GCC unroll 9
+		for (k = 0; k < i; k++)
+			sum -= f->L[i][k] * y[k];
+		y[i] = sum;
+	}
+	/* Back substitution (L' x = D^-1 y) */
+#pragma GCC unroll 9
+	for (i = 8; i >= 0; i--)
+	{
+		sum = y[i] * f->dinv[i];
+#pragma GCC unroll 9
+		for (k = i + 1; k < 9; k++)
+			sum -= f->L[k][i] * y[k];
+		y[i] = sum;
+	}
+	for (i = 0; i < 9; i++)
+		x[i] = y[i];
+}
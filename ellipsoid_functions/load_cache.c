@@ -0,0 +1,79 @@
+/**
+ * \file		load_cache.c
+ * \brief       Point cache in memory
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Loads the points of the data files into a single memory area (arena),
+ * 					as a structure of arrays: separate arrays of x, y, z and w for every
+ * 					group, aligned to the cache lines. The files are read only once and
+ * 					all the later passes use the arrays of the cache. The groups which
+ * 					do not fit in the memory budget are still read from their files
+ * \param[in,out]   df: Vector of the structures <data_file> of the data files
+ * \param[in]       t: Number of the data files
+ * \param[in]       budget: The maximum size of the cache (bytes)
+ * \return			The pointer to the arena (to be freed after the adjustment), or
+ * 					a null pointer if no group is cached
+ */
+double *load_cache(struct data_file *df, int t, size_t budget)
+{
+	register int i;
+	long j, k, n, len[t], line = CACHE_LINE / sizeof(double);
+	size_t total = 0;
+	double *arena, *a;
+	struct cart_coord buf[BLOCK];
+	struct span sp;
+
+	/* Length of the arrays of every group, rounded up to whole cache lines (zero for the groups which do not fit) */
+	for (i = 0; i < t; i++)
+	{
+		len[i] = (df[i].c + line - 1) / line * line;
+		if (total + 4 * len[i] * sizeof(double) > budget)
+			len[i] = 0;
+		total += 4 * len[i] * sizeof(double);
+	}
+	if (total == 0 || posix_memalign((void **)&arena, CACHE_LINE, total) != 0)
+		return NULL;
+	/* Copying the points of every group into its arrays */
+	for (a = arena, i = 0; i < t; i++)
+	{
+		if (len[i] == 0)
+			continue;
+		for (k = 0; (n = fetch_points(&df[i], k, df[i].c - k, buf, &sp)) > 0; k += n)
+			for (j = 0; j < n; j++)
+			{
+				a[k + j] = sp.x[j * sp.stride];
+				a[len[i] + k + j] = sp.y[j * sp.stride];
+				a[2 * len[i] + k + j] = sp.z[j * sp.stride];
+				a[3 * len[i] + k + j] = sp.w[j * sp.stride];
+			}
+		df[i].x = a;
+		df[i].y = a + len[i];
+		df[i].z = a + 2 * len[i];
+		df[i].w = a + 3 * len[i];
+		a += 4 * len[i];
+	}
+	return arena;
+}
@@ -0,0 +1,68 @@
+/**
+ * \file		load_text.c
+ * \brief       Loading of a text file of points
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Maps a text file of points (x y z w) read-only into memory and converts
+ * 					it into a vector of structures <cart_coord> by calling the function
+ * 					parse_points()
+ * \param[in]       name: The name of the text file
+ * \param[in]       threads: The number of threads of the parser
+ * \param[out]      pts: The vector of the points (to be freed by the caller)
+ * \param[out]      bad: The number of invalid lines
+ * \return			The number of points, or -1 if the file cannot be read or there
+ * 					is not enough memory
+ */
+long load_text(char *name, int threads, struct cart_coord **pts, long *bad)
+{
+	int fd;
+	long n;
+	struct stat st;
+	char *text;
+
+	*bad = 0;
+	if ((fd = open(name, O_RDONLY)) < 0)
+		return -1;
+	if (fstat(fd, &st) != 0)
+	{
+		close(fd);
+		return -1;
+	}
+	if (st.st_size == 0)
+	{
+		close(fd);
+		*pts = malloc(sizeof(struct cart_coord));
+		return (*pts == NULL) ? -1 : 0;
+	}
+	text = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (text == MAP_FAILED)
+		return -1;
+	madvise(text, st.st_size, MADV_SEQUENTIAL);
+	n = parse_points(text, st.st_size, threads, pts, bad);
+	munmap(text, st.st_size);
+	return n;
+}
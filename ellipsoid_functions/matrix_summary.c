@@ -39,23 +39,25 @@
 struct group summary(struct group *A, int n)
 {	
 	struct group SUM;
-	register int i, j, k;
+	register int i, j;
 	
 	/* Resetting the elements of the matrix N (of all froups) to zero */
-	zeros(&SUM.N_bar[0][0], 9, 9);
+	zeros(&SUM.N_bar[0], NPACK, 1);
 	/* Resetting the elements of the vector u (of all groups) to zero */
 	zeros(&SUM.U_bar[0], 9, 1);
 	SUM.sum_piwi2 = 0.0L;
+	SUM.weight = 0.0L;
+	SUM.c = 0;
 	/* Summation procedure */
 	for (i = 0; i < n; i++)
 	{
+		/* The packed matrices N are added by calling the function packed_axpy() */
+		packed_axpy(&SUM.N_bar[0], 1.0L, &A[i].N_bar[0]);
 		for (j = 0; j < 9; j++)
-		{
-			for (k = 0; k < 9; k++)
-				SUM.N_bar[j][k] += A[i].N_bar[j][k];
 			SUM.U_bar[j] += A[i].U_bar[j];	
-		}
-		SUM.sum_piwi2 += A[i].sum_piwi2;			
+		SUM.sum_piwi2 += A[i].sum_piwi2;
+		SUM.weight += A[i].weight;
+		SUM.c += A[i].c;
 	}
 	return SUM;
 }
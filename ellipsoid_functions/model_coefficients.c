@@ -0,0 +1,111 @@
+/**
+ * \file		model_coefficients.c
+ * \brief       Coefficients of the linearized ellipsoid model
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Calculates the coefficients of the linearized model (p coefficients
+ * 					and their partial derivatives) which are common to all the points
+ * \param[in]       values: Vector of the current values of the triaxial ellipsoid
+ * \param[out]      md: The structure <model> which receives the coefficients
+ */
+void model_coefficients(type *values, struct model *md)
+{
+	type theta_x, theta_y, theta_z, ax, ay, az;
+	type r11, r12, r13, r21, r22, r23, r31, r32, r33;
+	type A, B, C, sinx, cosx, siny, cosy, sinz, cosz;
+
+	/* Initial values */
+	md->tx = values[0]; /* [m] */
+	md->ty = values[1]; /* [m] */
+	md->tz = values[2]; /* [m] */
+	ax = values[3]; /* [m] */
+	ay = values[4]; /* [m] */
+	az = values[5]; /* [m] */
+	theta_x = values[6]; /* [rad] */
+	theta_y = values[7]; /* [rad] */
+	theta_z = values[8]; /* [rad] */
+	/* Calculating the elements of the rotation matrix */
+	sinx = sin(theta_x);
+	siny = sin(theta_y);
+	sinz = sin(theta_z);
+	cosx = cos(theta_x);
+	cosy = cos(theta_y);
+	cosz = cos(theta_z);
+	r11 = cosy * cosz;
+	r12 = cosx * sinz + sinx * siny * cosz;
+	r13 = sinx * sinz - cosx * siny * cosz;
+	r21 = -cosy * sinz;
+	r22 = cosx * cosz - sinx * siny * sinz;
+	r23 = sinx * cosz + cosx * siny * sinz;
+	r31 = siny;
+	r32 = -sinx * cosy;
+	r33 = cosx * cosy;
+	/* Calculating the p coefficients */
+	md->pxx = r11 * r11 / ax / ax + r21 * r21 / ay / ay + r31 * r31 / az / az;
+	md->pyy = r12 * r12 / ax / ax + r22 * r22 / ay / ay + r32 * r32 / az / az;
+	md->pzz = r13 * r13 / ax / ax + r23 * r23 / ay / ay + r33 * r33 / az / az;
+	md->pxy = r11 * r12 / ax / ax + r21 * r22 / ay / ay + r31 * r32 / az / az;
+	md->pxz = r11 * r13 / ax / ax + r21 * r23 / ay / ay + r31 * r33 / az / az;
+	md->pyz = r12 * r13 / ax / ax + r22 * r23 / ay / ay + r32 * r33 / az / az;
+	A = 1.0L / az / az - 1.0L / ax / ax;
+	B = 1.0L / ay / ay - 1.0L / az / az;
+	C = 1.0L / ax / ax - 1.0L / ay / ay;
+	/* Calculating the partial derivatives with respect to ax */
+	md->dpxx_dax = -2.0L * r11 * r11 / ax / ax / ax;
+	md->dpyy_dax = -2.0L * r12 * r12 / ax / ax / ax;
+	md->dpzz_dax = -2.0L * r13 * r13 / ax / ax / ax;
+	md->dpxy_dax = -2.0L * r11 * r12 / ax / ax / ax;
+	md->dpxz_dax = -2.0L * r11 * r13 / ax / ax / ax;
+	md->dpyz_dax = -2.0L * r12 * r13 / ax / ax / ax;
+	/* Calculating the partial derivatives with respect to ay */
+	md->dpxx_day = -2.0L * r21 * r21 / ay / ay / ay;
+	md->dpyy_day = -2.0L * r22 * r22 / ay / ay / ay;
+	md->dpzz_day = -2.0L * r23 * r23 / ay / ay / ay;
+	md->dpxy_day = -2.0L * r21 * r22 / ay / ay / ay;
+	md->dpxz_day = -2.0L * r21 * r23 / ay / ay / ay;
+	md->dpyz_day = -2.0L * r22 * r23 / ay / ay / ay;
+	/* Calculating the partial derivatives with respect to az */
+	md->dpxx_daz = -2.0L * r31 * r31 / az / az / az;
+	md->dpyy_daz = -2.0L * r32 * r32 / az / az / az;
+	md->dpzz_daz = -2.0L * r33 * r33 / az / az / az;
+	md->dpxy_daz = -2.0L * r31 * r32 / az / az / az;
+	md->dpxz_daz = -2.0L * r31 * r33 / az / az / az;
+	md->dpyz_daz = -2.0L * r32 * r33 / az / az / az;
+	/* Calculating the partial derivatives with respect to theta_y */
+	md->dpxx_dthy = 2.0L * (r11 * r31 * cosz * A + r21 * r31 * sinz * B);
+	md->dpyy_dthy = 2.0L * (r12 * r32 * cosz * A + r22 * r32 * sinz * B);
+	md->dpzz_dthy = 2.0L * (r13 * r33 * cosz * A + r23 * r33 * sinz * B);
+	md->dpxy_dthy = (r11 * r32 + r12 * r31) * cosz * A + (r21 * r32 + r22 * r31) * sinz * B;
+	md->dpxz_dthy = (r11 * r33 + r13 * r31) * cosz * A + (r21 * r33 + r23 * r31) * sinz * B;
+	md->dpyz_dthy = (r12 * r33 + r13 * r32) * cosz * A + (r22 * r33 + r23 * r32) * sinz * B;
+	/* Calculating the partial derivatives with respect to theta_z */
+	md->dpxx_dthz = 2.0L * r11 * r21 * C;
+	md->dpyy_dthz = 2.0L * r12 * r22 * C;
+	md->dpzz_dthz = 2.0L * r13 * r23 * C;
+	md->dpxy_dthz = (r11 * r22 + r12 * r21) * C;
+	md->dpxz_dthz = (r11 * r23 + r13 * r21) * C;
+	md->dpyz_dthz = (r12 * r23 + r13 * r22) * C;
+}
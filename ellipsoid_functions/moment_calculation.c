@@ -0,0 +1,84 @@
+/**
+ * \file		moment_calculation.c
+ * \brief       Moment sums of the points of the data files
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Adds a block of streamed points to the moment sums
+ * \param[in]       sp: The span of points
+ * \param[in]       arg: A pointer to the structure <moments>
+ */
+static void consume(struct span *sp, void *arg)
+{
+	moment_sums(sp, arg);
+}
+
+/**
+ * \brief           Calculates the moment sums of the points of the data files, which give
+ * 					the initial values by the function algebraic_fit(). The moment sums of
+ * 					the files with an index are taken from the index, without reading them
+ * \param[in]       df: Vector of the structures <data_file> of the data files
+ * \param[in]       file_num: Number of the data files
+ * \param[out]      mom: The structure <moments> of all the points
+ * \param[in]       opt: The run-time options (threads and streaming)
+ */
+void moment_calculation(struct data_file *df, int file_num, struct moments *mom, struct options *opt)
+{
+	register int i, j;
+	int m = 0;
+	bool plain = true;
+	long k, n;
+	struct data_file rest[file_num];
+	struct cart_coord buf[BLOCK];
+	struct span sp;
+	
+	/* Initializing the moment sums */
+	mom->c = 0;
+	for (i = 0; i < 34; i++)
+		mom->a[i] = 0.0L;
+	/* Adding the sums of the indexed files; the other files are read */
+	for (i = 0; i < file_num; i++)
+		if (df[i].indexed)
+		{
+			for (j = 0; j < 34; j++)
+				mom->a[j] += df[i].mom.a[j];
+			mom->c += df[i].mom.c;
+		}
+		else
+			rest[m++] = df[i];
+	/* Only the files which are read from the disk in every pass can be streamed */
+	for (i = 0; i < m; i++)
+		plain = plain && rest[i].map == NULL && rest[i].x == NULL && !rest[i].quantized;
+	/* Reading the files (binary files) and calculating the moment sums */
+	if (opt->threads > 1 && m > 0)
+		parallel_moments(rest, m, opt->threads, mom);
+	else if (opt->stream > 1 && m > 0 && plain)
+		/* Reading the files by a separate thread, while the sums of the previous block are calculated */
+		stream_points(rest, m, opt->stream, opt->block, consume, mom);
+	else
+		for (i = 0; i < m; i++)
+			for (k = 0; (n = fetch_points(&rest[i], k, rest[i].c - k, buf, &sp)) > 0; k += n)
+				moment_sums(&sp, mom);
+}
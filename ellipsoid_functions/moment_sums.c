@@ -0,0 +1,127 @@
+/**
+ * \file		moment_sums.c
+ * \brief       Moment sums of the algebraic fitting
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Adds the contribution of a span of points to the moment sums
+ * 					a1, ..., a34 of the algebraic fitting of the ellipsoid
+ * \param[in]       sp: The span of points (Cartesian coordinates and weights)
+ * \param[in,out]   mom: The structure <moments> which accumulates the sums
+ */
+void moment_sums(struct span *sp, struct moments *mom)
+{
+	register long k;
+	long n = sp->n, s = sp->stride;
+	double *x = sp->x, *y = sp->y, *z = sp->z;
+	type xi, yi, zi, xi2, yi2, zi2;
+	type a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11;
+	type a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22;
+	type a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34;
+
+	/* Initializing the partial sums */
+	a1 = a2 = a3 = a4 = a5 = a6 = a7 = a8 = a9 = a10 = a11 = 0.0L;
+	a12 = a13 = a14 = a15 = a16 = a17 = a18 = a19 = a20 = a21 = a22 = 0.0L;
+	a23 = a24 = a25 = a26 = a27 = a28 = a29 = a30 = a31 = a32 = a33 = a34 = 0.0L;
+	for (k = 0; k < n; k++)
+	{
+		xi = x[k * s];
+		yi = y[k * s];
+		zi = z[k * s];
+		xi2 = xi * xi;
+		yi2 = yi * yi;
+		zi2 = zi * zi;
+		a1 += xi2 * xi2; 
+		a2 += xi2 * yi2;
+		a3 += xi2 * zi2;
+		a4 += xi2 * xi * yi;
+		a5 += xi2 * xi * zi;
+		a6 += xi2 * yi * zi;
+		a7 += xi2 * xi;
+		a8 += xi2 * yi;
+		a9 += xi2 * zi;
+		a10 += yi2 * yi2;
+		a11 += yi2 * zi2;
+		a12 += xi * yi2 * yi;
+		a13 += xi * yi2 * zi;
+		a14 += yi2 * yi * zi;
+		a15 += xi * yi2;
+		a16 += yi2 * yi;
+		a17 += yi2 * zi;
+		a18 += zi2 * zi2;
+		a19 += xi * yi * zi2;
+		a20 += xi * zi2 * zi;
+		a21 += yi * zi2 * zi;
+		a22 += xi * zi2;
+		a23 += yi * zi2;
+		a24 += zi2 * zi;
+		a25 += xi * yi * zi;
+		a26 += xi2;
+		a27 += xi * yi;
+		a28 += xi * zi;
+		a29 += yi2;
+		a30 += yi * zi;
+		a31 += zi2;
+		a32 += xi;
+		a33 += yi;
+		a34 += zi;
+	}
+	/* Adding the partial sums to the structure <moments> */
+	mom->a[0] += a1;
+	mom->a[1] += a2;
+	mom->a[2] += a3;
+	mom->a[3] += a4;
+	mom->a[4] += a5;
+	mom->a[5] += a6;
+	mom->a[6] += a7;
+	mom->a[7] += a8;
+	mom->a[8] += a9;
+	mom->a[9] += a10;
+	mom->a[10] += a11;
+	mom->a[11] += a12;
+	mom->a[12] += a13;
+	mom->a[13] += a14;
+	mom->a[14] += a15;
+	mom->a[15] += a16;
+	mom->a[16] += a17;
+	mom->a[17] += a18;
+	mom->a[18] += a19;
+	mom->a[19] += a20;
+	mom->a[20] += a21;
+	mom->a[21] += a22;
+	mom->a[22] += a23;
+	mom->a[23] += a24;
+	mom->a[24] += a25;
+	mom->a[25] += a26;
+	mom->a[26] += a27;
+	mom->a[27] += a28;
+	mom->a[28] += a29;
+	mom->a[29] += a30;
+	mom->a[30] += a31;
+	mom->a[31] += a32;
+	mom->a[32] += a33;
+	mom->a[33] += a34;
+	mom->c += n;
+}
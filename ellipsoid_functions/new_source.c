@@ -0,0 +1,48 @@
+/**
+ * \file		new_source.c
+ * \brief       New source of points of a fit context
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Adds an empty source of points (structure <data_file>) to a fit context
+ * \param[in,out]   ctx: The fit context
+ * \return			The new source, or a null pointer if there is not enough memory
+ */
+struct data_file *new_source(struct ellipsoid_ctx *ctx)
+{
+	struct data_file *more, *df;
+
+	if (ctx->count == ctx->size)
+	{
+		if ((more = realloc(ctx->files, (ctx->size > 0 ? 2 * ctx->size : 8) * sizeof(struct data_file))) == NULL)
+			return NULL;
+		ctx->files = more;
+		ctx->size = ctx->size > 0 ? 2 * ctx->size : 8;
+	}
+	df = &ctx->files[ctx->count];
+	memset(df, 0, sizeof(struct data_file));
+	df->stride = 1;
+	return df;
+}
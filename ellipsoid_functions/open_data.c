@@ -0,0 +1,162 @@
+/**
+ * \file		open_data.c
+ * \brief       Opening of a data file
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Opens a data file (binary file) of points and calculates its number
+ * 					of complete points from the size of the file. A trailing partial
+ * 					point (incomplete record) is not used and its size is kept in the
+ * 					member tail. With the IO_MMAP backend the file is mapped read-only
+ * 					and its points are used directly from the mapped pages. Files with
+ * 					the extension .txt are parsed into memory by the function load_text().
+ * 					If the binary file has a valid index file (name.idx), its moment sums
+ * 					are kept, so that the initial values do not read the points. Files
+ * 					with the extension .qbin are quantized files, whose records are
+ * 					decoded by the function fetch_points(), and files with the extension
+ * 					.cbin are compressed files, whose offsets of the blocks are read
+ * \param[in]       name: The name of the data file
+ * \param[out]      df: The structure <data_file> of the opened file
+ * \param[in]       opt: The run-time options (input backend and threads)
+ * \return			Zero on success, or -1 if the file cannot be opened or mapped
+ */
+int open_data(char *name, struct data_file *df, struct options *opt)
+{
+	register long i;
+	struct stat st;
+	struct comp_header ch;
+	struct point_index idx;
+	char *ext = strrchr(name, '.');
+
+	df->name = name;
+	df->map = NULL;
+	df->map_size = 0;
+	df->tail = 0;
+	df->bad = 0;
+	df->parsed = false;
+	df->quantized = false;
+	df->qmap = NULL;
+	df->offsets = NULL;
+	df->indexed = false;
+	df->x = df->y = df->z = df->w = NULL;
+	df->stride = 1;
+	df->bytes = 0;
+	if (ext != NULL && strcmp(ext, ".txt") == 0)
+	{
+		df->fp = NULL;
+		df->parsed = true;
+		if ((df->c = load_text(name, opt->threads, &df->map, &df->bad)) < 0)
+			return -1;
+		if (stat(name, &st) == 0)
+			df->bytes = st.st_size;
+		return 0;
+	}
+	if ((df->fp = fopen(name, "rb")) == NULL)
+		return -1;
+	if (fstat(fileno(df->fp), &st) != 0)
+	{
+		fclose(df->fp);
+		return -1;
+	}
+	if (ext != NULL && strcmp(ext, ".qbin") == 0)
+	{
+		/* The header of a quantized file gives the size of its records */
+		df->quantized = true;
+		if (fread(&df->qh, sizeof(struct quant_header), 1, df->fp) != 1 || memcmp(df->qh.magic, QUANT_MAGIC, sizeof(df->qh.magic)) != 0
+				|| df->qh.version != QUANT_VERSION || (df->qh.record != 12 && df->qh.record != 16))
+		{
+			fclose(df->fp);
+			return -1;
+		}
+		df->c = (st.st_size - sizeof(struct quant_header)) / df->qh.record;
+		df->tail = (st.st_size - sizeof(struct quant_header)) % df->qh.record;
+	}
+	else if (ext != NULL && strcmp(ext, ".cbin") == 0)
+	{
+		/* The header of a compressed file is followed by the offsets of its blocks */
+		df->quantized = true;
+		if (fread(&ch, sizeof(struct comp_header), 1, df->fp) != 1 || memcmp(ch.magic, COMP_MAGIC, sizeof(ch.magic)) != 0
+				|| ch.version != COMP_VERSION || ch.block != BLOCK || ch.c < 0 || ch.blocks != (ch.c + BLOCK - 1) / BLOCK
+				|| (ch.qh.record != 12 && ch.qh.record != 16) || (df->offsets = malloc((ch.blocks + 1) * sizeof(long long))) == NULL)
+		{
+			fclose(df->fp);
+			return -1;
+		}
+		if (fread(df->offsets, sizeof(long long), ch.blocks + 1, df->fp) != (size_t)(ch.blocks + 1) || df->offsets[ch.blocks] != st.st_size)
+		{
+			close_data(df);
+			return -1;
+		}
+		for (i = 0; i < ch.blocks; i++)
+			if (df->offsets[i] < (long long)ftell(df->fp) || df->offsets[i + 1] < df->offsets[i] || df->offsets[i + 1] - df->offsets[i] > COMP_BLOCK_MAX)
+			{
+				close_data(df);
+				return -1;
+			}
+		df->qh = ch.qh;
+		df->c = ch.c;
+	}
+	else
+	{
+		df->c = st.st_size / sizeof(struct cart_coord);
+		df->tail = st.st_size % sizeof(struct cart_coord);
+	}
+	if (read_index(name, &idx) == 0 && idx.c == df->c)
+	{
+		df->indexed = true;
+		df->mom.c = idx.c;
+		for (i = 0; i < 34; i++)
+			df->mom.a[i] = (type)idx.a[i][0] + idx.a[i][1];
+	}
+	if (opt->io == IO_MMAP && df->c > 0 && df->quantized)
+	{
+		df->map_size = st.st_size;
+		df->qmap = mmap(NULL, df->map_size, PROT_READ, MAP_PRIVATE, fileno(df->fp), 0);
+		if (df->qmap == MAP_FAILED)
+		{
+			df->qmap = NULL;
+			close_data(df);
+			return -1;
+		}
+		madvise(df->qmap, df->map_size, MADV_SEQUENTIAL);
+	}
+	else if (opt->io == IO_MMAP && df->c > 0)
+	{
+		df->map_size = df->c * sizeof(struct cart_coord);
+		df->map = mmap(NULL, df->map_size, PROT_READ, MAP_PRIVATE, fileno(df->fp), 0);
+		if (df->map == MAP_FAILED)
+		{
+			df->map = NULL;
+			fclose(df->fp);
+			return -1;
+		}
+		/* The points are read once from the beginning to the end in every pass */
+		madvise(df->map, df->map_size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+		madvise(df->map, df->map_size, MADV_HUGEPAGE);
+#endif
+	}
+	return 0;
+}
@@ -0,0 +1,308 @@
+/**
+ * \file		options.c
+ * \brief       Command line options
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Reads the options given in the command line before the names of
+ * 					the data files. The available options are:
+ * 					-j, --threads N: number of threads (0 for all the processors)
+ * 					-m, --mmap: memory mapping of the data files
+ * 					-c, --cache MB: loading of the points into a cache of at most MB megabytes
+ * 					-s, --simd: double precision vector kernel
+ * 					-V, --validate: vector kernel, validated against the long double one
+ * 					-S, --stream NBUF: reading of the data files by a separate thread into NBUF buffers
+ * 					-B, --block N: number of points of every streaming buffer
+ * 					-U, --socket PATH: Unix socket of the daemon
+ * 					-D, --spool DIR: spool directory of the daemon
+ * 					-C, --checkpoint FILE: checkpoint of the sequential adjustments
+ * 					-N, --every N: number of groups between the checkpoints
+ * 					-R, --resume: resumption from the checkpoint
+ * 					-W, --window N: sliding window of the last N groups
+ * 					-K, --batch K: sequential updates with K groups at once, calculated concurrently
+ * 					-T, --tolerance TOL: convergence tolerance of the a-posteriori standard deviation
+ * 					-X, --step-tolerance TOL: convergence tolerance of the corrections (relative)
+ * 					-I, --iterations N: maximum number of iterations
+ * 					-L, --damping MODE: step control, halving or lm (Levenberg-Marquardt)
+ * 					-F, --coarse FRACTION: coarse iterations on subsamples, starting from FRACTION of the points
+ * 					-r, --robust FN[:K]: robust estimation, FN huber or tukey with the tuning constant K
+ * 					-A, --ransac N[:T]: RANSAC pre-fit with N hypotheses and the inlier threshold T (least median of squares without T)
+ * 					-P, --profile FILE: instrumentation report (JSON) of the stages and the iterations
+ * 					-H, --perf: hardware counters (cycles and instructions) in the report
+ * \param[in]       argc: The number of arguments that main was called (integer)
+ * \param[in]       argv: The vector of arguments (string)
+ * \param[out]      opt: The structure <options> which receives the options
+ * \return			The index of the first data file in argv, or -1 for an invalid option
+ */
+int options(int argc, char *argv[], struct options *opt)
+{
+	int ch;
+	char *end;
+	static struct option long_options[] = {
+		{"threads", required_argument, NULL, 'j'},
+		{"mmap", no_argument, NULL, 'm'},
+		{"cache", required_argument, NULL, 'c'},
+		{"simd", no_argument, NULL, 's'},
+		{"validate", no_argument, NULL, 'V'},
+		{"stream", required_argument, NULL, 'S'},
+		{"block", required_argument, NULL, 'B'},
+		{"socket", required_argument, NULL, 'U'},
+		{"spool", required_argument, NULL, 'D'},
+		{"checkpoint", required_argument, NULL, 'C'},
+		{"every", required_argument, NULL, 'N'},
+		{"resume", no_argument, NULL, 'R'},
+		{"window", required_argument, NULL, 'W'},
+		{"batch", required_argument, NULL, 'K'},
+		{"tolerance", required_argument, NULL, 'T'},
+		{"step-tolerance", required_argument, NULL, 'X'},
+		{"iterations", required_argument, NULL, 'I'},
+		{"damping", required_argument, NULL, 'L'},
+		{"coarse", required_argument, NULL, 'F'},
+		{"robust", required_argument, NULL, 'r'},
+		{"ransac", required_argument, NULL, 'A'},
+		{"profile", required_argument, NULL, 'P'},
+		{"perf", no_argument, NULL, 'H'},
+		{NULL, 0, NULL, 0}
+	};
+
+	/* Default options */
+	opt->threads = 1;
+	opt->io = IO_STDIO;
+	opt->cache = 0;
+	opt->simd = false;
+	opt->validate = false;
+	opt->stream = 0;
+	opt->block = STREAM_BLOCK;
+	opt->socket = NULL;
+	opt->spool = NULL;
+	opt->checkpoint = NULL;
+	opt->every = 1;
+	opt->resume = false;
+	opt->window = 0;
+	opt->batch = 1;
+	opt->tolerance = CONVTOL;
+	opt->step_tol = 0.0L;
+	opt->iterations = MAXITER;
+	opt->damping = DAMP_NONE;
+	opt->coarse = 0.0;
+	opt->robust = ROBUST_NONE;
+	opt->tuning = 0.0L;
+	opt->scale = 0.0L;
+	opt->ransac = 0;
+	opt->threshold = 0.0;
+	opt->profile = NULL;
+	opt->perf = false;
+	opt->prof = NULL;
+	while ((ch = getopt_long(argc, argv, "j:mc:sVS:B:U:D:C:N:RW:K:T:X:I:L:F:r:A:P:H", long_options, NULL)) != -1)
+		switch (ch)
+		{
+		case 'j':
+			opt->threads = atoi(optarg);
+			if (opt->threads == 0)
+				opt->threads = sysconf(_SC_NPROCESSORS_ONLN);
+			if (opt->threads < 1)
+			{
+				printf("\nInvalid number of threads %s", optarg);
+				return -1;
+			}
+			break;
+		case 'm':
+			opt->io = IO_MMAP;
+			break;
+		case 'c':
+			opt->cache = atol(optarg);
+			if (opt->cache < 1)
+			{
+				printf("\nInvalid size of the cache %s", optarg);
+				return -1;
+			}
+			break;
+		case 's':
+			opt->simd = true;
+			break;
+		case 'V':
+			opt->simd = true;
+			opt->validate = true;
+			break;
+		case 'S':
+			opt->stream = atoi(optarg);
+			if (opt->stream < 2)
+			{
+				printf("\nInvalid number of streaming buffers %s (at least 2)", optarg);
+				return -1;
+			}
+			break;
+		case 'B':
+			opt->block = atol(optarg);
+			if (opt->block < 1)
+			{
+				printf("\nInvalid number of points of a streaming buffer %s", optarg);
+				return -1;
+			}
+			break;
+		case 'U':
+			opt->socket = optarg;
+			break;
+		case 'D':
+			opt->spool = optarg;
+			break;
+		case 'C':
+			opt->checkpoint = optarg;
+			break;
+		case 'N':
+			opt->every = atoi(optarg);
+			if (opt->every < 1)
+			{
+				printf("\nInvalid number of groups between the checkpoints %s", optarg);
+				return -1;
+			}
+			break;
+		case 'R':
+			opt->resume = true;
+			break;
+		case 'W':
+			opt->window = atoi(optarg);
+			if (opt->window < 1)
+			{
+				printf("\nInvalid number of groups of the window %s", optarg);
+				return -1;
+			}
+			break;
+		case 'K':
+			opt->batch = atoi(optarg);
+			if (opt->batch < 1)
+			{
+				printf("\nInvalid number of groups of a sequential update %s", optarg);
+				return -1;
+			}
+			break;
+		case 'T':
+			opt->tolerance = strtold(optarg, NULL);
+			if (!(opt->tolerance > 0.0L))
+			{
+				printf("\nInvalid convergence tolerance %s", optarg);
+				return -1;
+			}
+			break;
+		case 'X':
+			opt->step_tol = strtold(optarg, NULL);
+			if (!(opt->step_tol >= 0.0L))
+			{
+				printf("\nInvalid convergence tolerance of the corrections %s", optarg);
+				return -1;
+			}
+			break;
+		case 'I':
+			opt->iterations = atoi(optarg);
+			if (opt->iterations < 1)
+			{
+				printf("\nInvalid maximum number of iterations %s", optarg);
+				return -1;
+			}
+			break;
+		case 'L':
+			if (strcmp(optarg, "halving") == 0)
+				opt->damping = DAMP_HALVING;
+			else if (strcmp(optarg, "lm") == 0)
+				opt->damping = DAMP_LM;
+			else
+			{
+				printf("\nInvalid step control %s (halving or lm)", optarg);
+				return -1;
+			}
+			break;
+		case 'F':
+			opt->coarse = atof(optarg);
+			if (!(opt->coarse > 0.0 && opt->coarse < 1.0))
+			{
+				printf("\nInvalid fraction of the points of the coarse iterations %s (between 0 and 1)", optarg);
+				return -1;
+			}
+			break;
+		case 'r':
+			if (strncmp(optarg, "huber", 5) == 0)
+			{
+				opt->robust = ROBUST_HUBER;
+				opt->tuning = HUBER_K;
+			}
+			else if (strncmp(optarg, "tukey", 5) == 0)
+			{
+				opt->robust = ROBUST_TUKEY;
+				opt->tuning = TUKEY_C;
+			}
+			else
+			{
+				printf("\nInvalid weight function %s (huber or tukey)", optarg);
+				return -1;
+			}
+			if (optarg[5] == ':')
+				opt->tuning = strtold(&optarg[6], NULL);
+			if ((optarg[5] != '\0' && optarg[5] != ':') || !(opt->tuning > 0.0L))
+			{
+				printf("\nInvalid weight function %s", optarg);
+				return -1;
+			}
+			break;
+		case 'A':
+			opt->ransac = strtol(optarg, &end, 10);
+			if (*end == ':')
+				opt->threshold = atof(end + 1);
+			if (opt->ransac < 1 || (*end != '\0' && *end != ':') || !(opt->threshold >= 0.0))
+			{
+				printf("\nInvalid RANSAC pre-fit %s", optarg);
+				return -1;
+			}
+			break;
+		case 'P':
+			opt->profile = optarg;
+			break;
+		case 'H':
+			opt->perf = true;
+			break;
+		default:
+			return -1;
+		}
+	if (opt->resume && opt->checkpoint == NULL)
+	{
+		printf("\nThe option -R needs a checkpoint file (-C)");
+		return -1;
+	}
+	if (opt->perf && opt->profile == NULL)
+	{
+		printf("\nThe option -H needs a report file (-P)");
+		return -1;
+	}
+	if (opt->window > 0 && opt->batch > opt->window)
+	{
+		printf("\nThe groups of a sequential update (-K) cannot be more than the groups of the window (-W)");
+		return -1;
+	}
+	if (opt->checkpoint != NULL && opt->window > 0)
+	{
+		printf("\nThe options -C and -W cannot be combined (the checkpoint does not keep the groups of the window)");
+		return -1;
+	}
+	return optind;
+}
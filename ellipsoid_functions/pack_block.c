@@ -0,0 +1,85 @@
+/**
+ * \file		pack_block.c
+ * \brief       Compression of a block of quantized points
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Compresses a block of records of the quantized format. For every
+ * 					coordinate the differences of consecutive values are zigzag encoded
+ * 					(small negative and positive values become small unsigned values) and
+ * 					packed with the smallest bit width which holds all of them
+ * \param[in]       rec: The records of the block (n * qh->record bytes)
+ * \param[in]       n: The number of points of the block (at most BLOCK)
+ * \param[in]       qh: The header of the quantized format
+ * \param[out]      out: The compressed block (at most COMP_BLOCK_MAX bytes)
+ * \return			The size of the compressed block (bytes)
+ */
+size_t pack_block(const unsigned char *rec, long n, struct quant_header *qh, unsigned char *out)
+{
+	register int i;
+	long k;
+	int X, width, nb;
+	long long prev, d;
+	unsigned long long zz[BLOCK], all, acc;
+	unsigned char *p = out;
+
+	for (i = 0; i < 3; i++)
+	{
+		/* Zigzag encoding of the differences */
+		memcpy(&X, rec + i * sizeof(int), sizeof(int));
+		prev = X;
+		for (k = 1, all = 0; k < n; k++)
+		{
+			memcpy(&X, rec + k * qh->record + i * sizeof(int), sizeof(int));
+			d = X - prev;
+			prev = X;
+			zz[k] = ((unsigned long long)d << 1) ^ (unsigned long long)(d >> 63);
+			all |= zz[k];
+		}
+		width = (all == 0) ? 0 : 64 - __builtin_clzll(all);
+		*p++ = width;
+		memcpy(&X, rec + i * sizeof(int), sizeof(int));
+		memcpy(p, &X, sizeof(int));
+		p += sizeof(int);
+		/* Packing the differences, from the least significant bit */
+		for (k = 1, acc = 0, nb = 0; k < n; k++)
+		{
+			acc |= zz[k] << nb;
+			nb += width;
+			while (nb >= 8)
+			{
+				*p++ = acc;
+				acc >>= 8;
+				nb -= 8;
+			}
+		}
+		if (nb > 0)
+			*p++ = acc;
+	}
+	if (qh->record > 12)
+		for (k = 0; k < n; k++, p += sizeof(float))
+			memcpy(p, rec + k * qh->record + 12, sizeof(float));
+	return p - out;
+}
@@ -0,0 +1,43 @@
+/**
+ * \file		packed_axpy.c
+ * \brief       Linear combination of packed symmetric matrices
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Adds a multiple of a packed symmetric 9x9 matrix to another one,
+ * 					Y = Y + a X, on the NPACK distinct elements (upper triangle by rows)
+ * 					in one contiguous loop
+ * \param[in,out]   Y: The packed matrix which receives the sum
+ * \param[in]       a: The factor of X (e.g. 1 for a sum, -1 for a difference)
+ * \param[in]       X: The packed matrix which is added
+ */
+void packed_axpy(type *Y, type a, type *X)
+{
+	register int q;
+
+#pragma GCC unroll 9
+	for (q = 0; q < NPACK; q++)
+		Y[q] += a * X[q];
+}
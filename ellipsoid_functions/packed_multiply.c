@@ -0,0 +1,47 @@
+/**
+ * \file		packed_multiply.c
+ * \brief       Product of a packed symmetric matrix with a vector
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Multiplies a packed symmetric 9x9 matrix with a vector, y = N x. The
+ * 					element (i, j) of the lower triangle is the element (j, i) of the upper one
+ * \param[in]       N: The packed matrix (upper triangle by rows)
+ * \param[in]       x: The vector (9 elements)
+ * \param[out]      y: The product (9 elements)
+ */
+void packed_multiply(type *N, type *x, type *y)
+{
+	register int i, j;
+	type sum;
+
+	for (i = 0; i < 9; i++)
+	{
+		sum = 0.0L;
+		for (j = 0; j < 9; j++)
+			sum += N[UPPER(i, j)] * x[j];
+		y[i] = sum;
+	}
+}
@@ -0,0 +1,112 @@
+/**
+ * \file		parallel_calculation.c
+ * \brief       Multithreaded calculation of the matrix N and the vector u
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/* A structure for the work of a thread: a range of points of a data file and its contribution */
+struct range {
+	struct data_file *df;
+	long first;
+	long n;
+	struct model *md;
+	struct group part;
+};
+
+/**
+ * \brief           Accumulates the contribution of a range of points into the private
+ * 					structure <group> of the thread
+ * \param[in]       arg: A pointer to the structure <range> of the thread
+ * \return			A null pointer
+ */
+static void *range_worker(void *arg)
+{
+	struct range *rg = arg;
+	struct cart_coord buf[BLOCK];
+	struct span sp;
+	long i, n;
+
+	for (i = 0; i < rg->n; i += n)
+	{
+		if ((n = fetch_points(rg->df, rg->first + i, rg->n - i, buf, &sp)) <= 0)
+			break;
+		rg->md->kernel(&sp, rg->md, &rg->part);
+	}
+	return NULL;
+}
+
+/**
+ * \brief           Calculates the matrix N and the vector u of a data file by splitting
+ * 					its points into ranges which are processed by different threads.
+ * 					Every thread owns a private structure <group> and the partial
+ * 					results are added by the function summary()
+ * \param[in]       df: The structure <data_file> of the data file
+ * \param[in]       md: The coefficients of the linearized model
+ * \param[in]       threads: The number of threads
+ * \param[out]      matr: The structure <group> which receives the upper triangular
+ * 					matrix N, the vector u and the sum of the weighted squared misclosures
+ */
+void parallel_calculation(struct data_file *df, struct model *md, int threads, struct group *matr)
+{
+	register int i;
+	long c = df->c, step;
+
+	/* Every thread must take at least MINRANGE points */
+	if (threads > c / MINRANGE)
+		threads = c / MINRANGE;
+	if (threads < 1)
+		threads = 1;
+	step = c / threads;
+	{
+		pthread_t tid[threads];
+		bool started[threads];
+		struct range rg[threads];
+		struct group parts[threads];
+
+		for (i = 0; i < threads; i++)
+		{
+			rg[i].df = df;
+			rg[i].md = md;
+			rg[i].first = i * step;
+			rg[i].n = (i == threads - 1) ? c - rg[i].first : step;
+			zeros(&rg[i].part.N_bar[0], NPACK, 1);
+			zeros(&rg[i].part.U_bar[0], 9, 1);
+			rg[i].part.sum_piwi2 = 0.0L;
+			rg[i].part.weight = 0.0L;
+			rg[i].part.c = 0;
+			/* The first range is processed by the calling thread */
+			started[i] = i > 0 && pthread_create(&tid[i], NULL, range_worker, &rg[i]) == 0;
+		}
+		for (i = 0; i < threads; i++)
+		{
+			if (started[i])
+				pthread_join(tid[i], NULL);
+			else
+				range_worker(&rg[i]);
+		}
+		for (i = 0; i < threads; i++)
+			parts[i] = rg[i].part;
+		*matr = summary(parts, threads);
+	}
+}
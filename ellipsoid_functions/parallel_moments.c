@@ -0,0 +1,121 @@
+/**
+ * \file		parallel_moments.c
+ * \brief       Multithreaded calculation of the moment sums
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/* A structure for the work of a thread: a slice of the points of all data files and its moment sums */
+struct slice {
+	struct data_file *df;
+	int file_num;
+	long first;
+	long n;
+	struct moments part;
+};
+
+/**
+ * \brief           Accumulates the moment sums of a slice of points into the private
+ * 					structure <moments> of the thread. The slice is defined on the
+ * 					points of all files, taken in the order of the files
+ * \param[in]       arg: A pointer to the structure <slice> of the thread
+ * \return			A null pointer
+ */
+static void *slice_worker(void *arg)
+{
+	struct slice *sl = arg;
+	struct cart_coord buf[BLOCK];
+	struct span sp;
+	register int i;
+	long start = 0, first, last, n;
+
+	for (i = 0; i < sl->file_num; start += sl->df[i].c, i++)
+	{
+		/* The part of the slice which belongs to the file i */
+		first = (sl->first > start) ? sl->first - start : 0;
+		last = (sl->first + sl->n < start + sl->df[i].c) ? sl->first + sl->n - start : sl->df[i].c;
+		for (; first < last; first += n)
+		{
+			if ((n = fetch_points(&sl->df[i], first, last - first, buf, &sp)) <= 0)
+				break;
+			moment_sums(&sp, &sl->part);
+		}
+	}
+	return NULL;
+}
+
+/**
+ * \brief           Calculates the moment sums a1, ..., a34 of all the data files by
+ * 					splitting their points into equal slices which are processed by
+ * 					different threads
+ * \param[in]       df: Vector of the structures <data_file> of the data files
+ * \param[in]       file_num: Number of the data files
+ * \param[in]       threads: The number of threads
+ * \param[in,out]   mom: The structure <moments> which accumulates the sums
+ */
+void parallel_moments(struct data_file *df, int file_num, int threads, struct moments *mom)
+{
+	register int i, j;
+	long c = 0, step;
+
+	for (i = 0; i < file_num; i++)
+		c += df[i].c;
+	/* Every thread must take at least MINRANGE points */
+	if (threads > c / MINRANGE)
+		threads = c / MINRANGE;
+	if (threads < 1)
+		threads = 1;
+	step = c / threads;
+	{
+		pthread_t tid[threads];
+		bool started[threads];
+		struct slice sl[threads];
+
+		for (i = 0; i < threads; i++)
+		{
+			sl[i].df = df;
+			sl[i].file_num = file_num;
+			sl[i].first = i * step;
+			sl[i].n = (i == threads - 1) ? c - sl[i].first : step;
+			sl[i].part.c = 0;
+			for (j = 0; j < 34; j++)
+				sl[i].part.a[j] = 0.0L;
+			/* The first slice is processed by the calling thread */
+			started[i] = i > 0 && pthread_create(&tid[i], NULL, slice_worker, &sl[i]) == 0;
+		}
+		for (i = 0; i < threads; i++)
+		{
+			if (started[i])
+				pthread_join(tid[i], NULL);
+			else
+				slice_worker(&sl[i]);
+		}
+		/* Adding the partial sums of the threads */
+		for (i = 0; i < threads; i++)
+		{
+			for (j = 0; j < 34; j++)
+				mom->a[j] += sl[i].part.a[j];
+			mom->c += sl[i].part.c;
+		}
+	}
+}
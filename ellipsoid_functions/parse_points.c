@@ -0,0 +1,275 @@
+/**
+ * \file		parse_points.c
+ * \brief       Multithreaded parser of the text files of points
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/* A structure for the work of a thread: a chunk of whole lines of the text and its points */
+struct chunk {
+	const char *begin;
+	const char *end;
+	struct cart_coord *pts;
+	long n;
+	long bad;
+	bool failed;
+};
+
+/* The powers of ten which are exact in double precision */
+static const double pow10[23] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/* The C locale of the slow path, created once by the function c_locale_init() */
+static locale_t c_locale;
+static pthread_once_t c_locale_once = PTHREAD_ONCE_INIT;
+
+/**
+ * \brief           Creates the C locale of the numbers which are passed to strtod()
+ */
+static void c_locale_init(void)
+{
+	c_locale = newlocale(LC_ALL_MASK, "C", (locale_t)0);
+}
+
+/**
+ * \brief           Reads a decimal number without the locale. The significant digits
+ * 					are kept in an integer; when they fit in the mantissa of a double and
+ * 					the power of ten is exact, one multiplication or division gives the
+ * 					correctly rounded value, otherwise the number is passed to strtod()
+ * 					in the C locale of the thread, whatever the locale of the program
+ * \param[in]       p: The first character of the number (after any blanks)
+ * \param[in]       end: The end of the text
+ * \param[out]      next: The first character after the number
+ * \param[out]      v: The value of the number
+ * \return			True if a number was read
+ */
+static bool parse_double(const char *p, const char *end, const char **next, double *v)
+{
+	unsigned long long mant = 0;
+	int digits = 0, scale = 0, e = 0, esign = 1;
+	bool neg = false, any = false;
+	const char *q, *start = p;
+	char token[64], *copy;
+	locale_t old;
+
+	if (p < end && (*p == '-' || *p == '+'))
+		neg = *p++ == '-';
+	for (; p < end && *p >= '0' && *p <= '9'; p++, any = true)
+		if (digits < 19)
+		{
+			if ((mant = mant * 10 + (*p - '0')) != 0)
+				digits++;
+		}
+		else
+			scale++;
+	if (p < end && *p == '.')
+		for (p++; p < end && *p >= '0' && *p <= '9'; p++, any = true)
+			if (digits < 19)
+			{
+				if ((mant = mant * 10 + (*p - '0')) != 0)
+					digits++;
+				scale--;
+			}
+	if (!any)
+		return false;
+	if (p < end && (*p == 'e' || *p == 'E'))
+	{
+		q = p + 1;
+		if (q < end && (*q == '-' || *q == '+'))
+			esign = (*q++ == '-') ? -1 : 1;
+		if (q < end && *q >= '0' && *q <= '9')
+		{
+			for (; q < end && *q >= '0' && *q <= '9'; q++)
+				if (e < 100000)
+					e = e * 10 + (*q - '0');
+			scale += esign * e;
+			p = q;
+		}
+	}
+	*next = p;
+	if (mant < (1ULL << 53) && scale >= -22 && scale <= 22)
+	{
+		*v = (scale >= 0) ? (double)mant * pow10[scale] : (double)mant / pow10[-scale];
+		if (neg)
+			*v = -*v;
+		return true;
+	}
+	/* The text is not terminated, so the number is copied (long numbers into the heap) */
+	pthread_once(&c_locale_once, c_locale_init);
+	copy = (p - start < (long)sizeof(token)) ? token : malloc(p - start + 1);
+	if (c_locale == (locale_t)0 || copy == NULL)
+		return false;
+	memcpy(copy, start, p - start);
+	copy[p - start] = '\0';
+	old = uselocale(c_locale);
+	*v = strtod(copy, NULL);
+	uselocale(old);
+	if (copy != token)
+		free(copy);
+	return true;
+}
+
+/**
+ * \brief           Parses the lines "x y z w" of a chunk of the text. Empty lines and
+ * 					lines which start with # are ignored, a missing weight is set to 1
+ * 					and the other lines are counted as invalid
+ * \param[in]       arg: A pointer to the structure <chunk> of the thread
+ * \return			A null pointer
+ */
+static void *parse_chunk(void *arg)
+{
+	struct chunk *ch = arg;
+	const char *p = ch->begin, *end = ch->end, *eol;
+	long cap = (end - p) / 32 + 16;
+	double v[4];
+	int k;
+	struct cart_coord *grown;
+
+	ch->n = ch->bad = 0;
+	ch->failed = false;
+	if ((ch->pts = malloc(cap * sizeof(struct cart_coord))) == NULL)
+	{
+		ch->failed = true;
+		return NULL;
+	}
+	while (p < end)
+	{
+		if ((eol = memchr(p, '\n', end - p)) == NULL)
+			eol = end;
+		for (k = 0; k < 4; k++)
+		{
+			while (p < eol && (*p == ' ' || *p == '\t' || *p == '\r' || *p == ','))
+				p++;
+			if (p == eol || *p == '#' || !parse_double(p, eol, &p, &v[k]))
+				break;
+		}
+		while (p < eol && (*p == ' ' || *p == '\t' || *p == '\r'))
+			p++;
+		if (k == 3 && (p == eol || *p == '#'))
+			v[k++] = 1.0;
+		if (k == 4 && (p == eol || *p == '#'))
+		{
+			if (ch->n == cap)
+			{
+				if ((grown = realloc(ch->pts, 2 * cap * sizeof(struct cart_coord))) == NULL)
+				{
+					ch->failed = true;
+					return NULL;
+				}
+				ch->pts = grown;
+				cap *= 2;
+			}
+			ch->pts[ch->n].x = v[0];
+			ch->pts[ch->n].y = v[1];
+			ch->pts[ch->n].z = v[2];
+			ch->pts[ch->n].w = v[3];
+			ch->n++;
+		}
+		else if (k > 0 || (p < eol && *p != '#'))
+			ch->bad++;
+		p = eol + 1;
+	}
+	return NULL;
+}
+
+/**
+ * \brief           Converts a text of points (x y z w, one point per line, separated by
+ * 					blanks) into a vector of structures <cart_coord>. The text is split
+ * 					into chunks of whole lines which are parsed by different threads and
+ * 					the points are kept in the order of the text. The numbers are read
+ * 					independently of the locale and are identical to the values of
+ * 					strtod() in the C locale
+ * \param[in]       text: The text
+ * \param[in]       len: The length of the text (bytes)
+ * \param[in]       threads: The number of threads
+ * \param[out]      pts: The vector of the points (to be freed by the caller)
+ * \param[out]      bad: The number of invalid lines
+ * \return			The number of points, or -1 if there is not enough memory
+ */
+long parse_points(const char *text, size_t len, int threads, struct cart_coord **pts, long *bad)
+{
+	register int i;
+	long n = 0;
+	const char *cut;
+
+	/* Every thread must take at least MINRANGE bytes */
+	if (threads > (long)(len / MINRANGE))
+		threads = len / MINRANGE;
+	if (threads < 1)
+		threads = 1;
+	{
+		pthread_t tid[threads];
+		bool started[threads];
+		struct chunk ch[threads];
+
+		/* The chunks end after a new line character */
+		for (i = 0, cut = text; i < threads; i++)
+		{
+			ch[i].begin = cut;
+			cut = (i == threads - 1) ? text + len : text + len / threads * (i + 1);
+			if (cut < ch[i].begin)
+				cut = ch[i].begin;
+			while (cut < text + len && cut > text && cut[-1] != '\n')
+				cut++;
+			ch[i].end = cut;
+			started[i] = i > 0 && pthread_create(&tid[i], NULL, parse_chunk, &ch[i]) == 0;
+		}
+		for (i = 0; i < threads; i++)
+		{
+			if (started[i])
+				pthread_join(tid[i], NULL);
+			else
+				parse_chunk(&ch[i]);
+		}
+		/* Joining the points of the chunks */
+		*bad = 0;
+		for (i = 0; i < threads; i++)
+		{
+			n += ch[i].n;
+			*bad += ch[i].bad;
+		}
+		if (threads == 1)
+		{
+			*pts = ch[0].pts;
+			return ch[0].failed ? -1 : n;
+		}
+		*pts = malloc((n > 0 ? n : 1) * sizeof(struct cart_coord));
+		for (i = 0, n = 0; i < threads; i++)
+		{
+			if (ch[i].failed || *pts == NULL)
+				n = -1;
+			else if (n >= 0)
+			{
+				memcpy(*pts + n, ch[i].pts, ch[i].n * sizeof(struct cart_coord));
+				n += ch[i].n;
+			}
+			free(ch[i].pts);
+		}
+		if (n < 0)
+		{
+			free(*pts);
+			*pts = NULL;
+		}
+	}
+	return n;
+}
@@ -0,0 +1,215 @@
+/**
+ * \file		profile.c
+ * \brief       Monotonic timers, hardware counters and iterations of the instrumentation
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/* The member type of the structure perf_event_attr is hidden by the data type macro */
+#undef type
+
+/**
+ * \brief           Opens a hardware counter of the calling thread and of the threads
+ * 					which are created later (user space only)
+ * \param[in]       which: Zero for the processor cycles, one for the instructions
+ * \return			The descriptor of the counter, or -1 if it is not available
+ */
+static int open_counter(int which)
+{
+#ifdef __linux__
+	struct perf_event_attr pe;
+
+	memset(&pe, 0, sizeof(pe));
+	pe.type = PERF_TYPE_HARDWARE;
+	pe.size = sizeof(pe);
+	pe.config = (which == 0) ? PERF_COUNT_HW_CPU_CYCLES : PERF_COUNT_HW_INSTRUCTIONS;
+	pe.inherit = 1;
+	pe.exclude_kernel = 1;
+	pe.exclude_hv = 1;
+	return syscall(SYS_perf_event_open, &pe, 0, -1, -1, 0);
+#else
+	(void)which;
+	return -1;
+#endif
+}
+
+#define type long double /* Data type */
+
+/**
+ * \brief           Reads a hardware counter
+ * \param[in]       fd: The descriptor of the counter
+ * \return			The value of the counter, or zero without counter
+ */
+static long long read_counter(int fd)
+{
+	long long value;
+
+	if (fd < 0 || read(fd, &value, sizeof(value)) != sizeof(value))
+		return 0;
+	return value;
+}
+
+/**
+ * \brief           Gives the time of a clock in seconds
+ * \param[in]       id: The clock (CLOCK_MONOTONIC for the wall time,
+ * 					CLOCK_PROCESS_CPUTIME_ID for the processor time of all the threads)
+ * \return			The time of the clock (s)
+ */
+double clock_seconds(clockid_t id)
+{
+	struct timespec ts;
+
+	clock_gettime(id, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * \brief           Starts the instrumentation of a run. The counters of the bytes read
+ * 					from the data files are reset, so that it is called before the files
+ * 					are opened. The hardware counters count the threads which are created
+ * 					after this call, i.e. the workers of all the stages
+ * \param[out]      prof: The structure <profile> of the run
+ * \param[in,out]   files: Vector of the structures <data_file> of the data files
+ * \param[in]       nfiles: The number of the data files
+ * \param[in]       perf: Opening of the hardware counters (cycles and instructions)
+ * \return			Zero on success, or -1 if the hardware counters are not available
+ */
+int profile_init(struct profile *prof, struct data_file *files, int nfiles, bool perf)
+{
+	register int i;
+
+	prof->files = files;
+	prof->nfiles = nfiles;
+	for (i = 0; i < nfiles; i++)
+		files[i].bytes = 0;
+	memset(prof->stage, 0, sizeof(prof->stage));
+	prof->iter = NULL;
+	prof->count = prof->size = 0;
+	prof->fd[0] = prof->fd[1] = -1;
+	if (perf && ((prof->fd[0] = open_counter(0)) < 0 || (prof->fd[1] = open_counter(1)) < 0))
+	{
+		if (prof->fd[0] >= 0)
+			close(prof->fd[0]);
+		prof->fd[0] = -1;
+	}
+	prof->wall = clock_seconds(CLOCK_MONOTONIC);
+	prof->cpu = clock_seconds(CLOCK_PROCESS_CPUTIME_ID);
+	return (perf && prof->fd[0] < 0) ? -1 : 0;
+}
+
+/**
+ * \brief           Reads the clocks, the bytes read and the hardware counters
+ * 					at the beginning of a stage
+ * \param[in]       prof: The structure <profile> of the run, or a null pointer
+ * \param[out]      tm: The structure <stage_timer> of the stage
+ */
+void stage_begin(struct profile *prof, struct stage_timer *tm)
+{
+	register int i;
+
+	if (prof == NULL)
+		return;
+	for (i = 0, tm->bytes = 0; i < prof->nfiles; i++)
+		tm->bytes += __atomic_load_n(&prof->files[i].bytes, __ATOMIC_RELAXED);
+	tm->cycles = read_counter(prof->fd[0]);
+	tm->instructions = read_counter(prof->fd[1]);
+	tm->cpu = clock_seconds(CLOCK_PROCESS_CPUTIME_ID);
+	tm->wall = clock_seconds(CLOCK_MONOTONIC);
+}
+
+/**
+ * \brief           Adds the times, the bytes read and the hardware counters
+ * 					of a stage, since the call of the function stage_begin()
+ * \param[in,out]   prof: The structure <profile> of the run, or a null pointer
+ * \param[in]       stage: The stage (PROF_OPEN, ..., PROF_COVARIANCE)
+ * \param[in]       tm: The structure <stage_timer> of the stage
+ * \param[in]       points: The number of the processed points
+ */
+void stage_end(struct profile *prof, int stage, struct stage_timer *tm, long long points)
+{
+	register int i;
+	struct stage_stats *st;
+	long long bytes = 0;
+
+	if (prof == NULL)
+		return;
+	st = &prof->stage[stage];
+	st->wall += clock_seconds(CLOCK_MONOTONIC) - tm->wall;
+	st->cpu += clock_seconds(CLOCK_PROCESS_CPUTIME_ID) - tm->cpu;
+	st->cycles += read_counter(prof->fd[0]) - tm->cycles;
+	st->instructions += read_counter(prof->fd[1]) - tm->instructions;
+	for (i = 0; i < prof->nfiles; i++)
+		bytes += __atomic_load_n(&prof->files[i].bytes, __ATOMIC_RELAXED);
+	st->bytes += bytes - tm->bytes;
+	st->points += points;
+	st->calls++;
+}
+
+/**
+ * \brief           Records an iteration (or an added group) of the adjustment
+ * \param[in,out]   prof: The structure <profile> of the run, or a null pointer
+ * \param[in]       group: The number of the group (starting from one, zero for the coarse iterations on subsamples)
+ * \param[in]       iteration: The number of the iteration (starting from one)
+ * \param[in]       sigma0: The a-posteriori standard deviation
+ * \param[in]       ds: Vector of the corrections of the 9 parameters (m and rad)
+ */
+void profile_iteration(struct profile *prof, int group, int iteration, type sigma0, type *ds)
+{
+	register int i;
+	struct iteration_stats *it;
+	type step = 0.0L;
+
+	if (prof == NULL)
+		return;
+	if (prof->count == prof->size)
+	{
+		if ((it = realloc(prof->iter, (2 * prof->size + 16) * sizeof(struct iteration_stats))) == NULL)
+			return;
+		prof->iter = it;
+		prof->size = 2 * prof->size + 16;
+	}
+	for (i = 0; i < 9; i++)
+		step += ds[i] * ds[i];
+	it = &prof->iter[prof->count++];
+	it->group = group;
+	it->iteration = iteration;
+	it->sigma0 = sigma0;
+	it->step = sqrt(step);
+	it->time = clock_seconds(CLOCK_MONOTONIC) - prof->wall;
+}
+
+/**
+ * \brief           Closes the hardware counters and frees the iterations of the instrumentation
+ * \param[in,out]   prof: The structure <profile> of the run
+ */
+void profile_free(struct profile *prof)
+{
+	if (prof->fd[0] >= 0)
+		close(prof->fd[0]);
+	if (prof->fd[1] >= 0)
+		close(prof->fd[1]);
+	prof->fd[0] = prof->fd[1] = -1;
+	free(prof->iter);
+	prof->iter = NULL;
+	prof->count = prof->size = 0;
+}
@@ -0,0 +1,66 @@
+/**
+ * \file		quant_init.c
+ * \brief       Quantization parameters of a data file
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Calculates the header of the quantized format of a data file. The
+ * 					scale and the offset of every coordinate map the bounding box of the
+ * 					points (function index_data()) onto the range of int32, and the
+ * 					records have 12 bytes if all the points have the same weight
+ * \param[in]       df: The structure <data_file> of the file
+ * \param[out]      qh: The header of the quantized format (without the errors)
+ */
+void quant_init(struct data_file *df, struct quant_header *qh)
+{
+	register int i;
+	long j, k, n;
+	bool same = true;
+	double w0 = 1.0;
+	struct cart_coord buf[BLOCK];
+	struct span sp;
+	struct point_index idx;
+
+	index_data(df, &idx);
+	for (k = 0; same && (n = fetch_points(df, k, df->c - k, buf, &sp)) > 0; k += n)
+		for (j = 0; j < n; j++)
+		{
+			if (k + j == 0)
+				w0 = sp.w[0];
+			same = same && sp.w[j * sp.stride] == w0;
+		}
+	memset(qh, 0, sizeof(struct quant_header));
+	memcpy(qh->magic, QUANT_MAGIC, sizeof(qh->magic));
+	qh->version = QUANT_VERSION;
+	qh->record = same ? 12 : 16;
+	qh->weight = w0;
+	for (i = 0; i < 3; i++)
+	{
+		qh->offset[i] = (df->c > 0) ? 0.5 * (idx.min[i] + idx.max[i]) : 0.0;
+		qh->scale[i] = (df->c > 0) ? (idx.max[i] - idx.min[i]) / (2.0 * QUANT_MAX) : 0.0;
+		if (qh->scale[i] <= 0.0)
+			qh->scale[i] = 1.0;
+	}
+}
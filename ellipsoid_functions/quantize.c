@@ -0,0 +1,128 @@
+/**
+ * \file		quantize.c
+ * \brief       Conversion of data files into the quantized format
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Converts a data file (binary, text or quantized file) into a quantized
+ * 					file (extension .qbin) and its index file. The coordinates are stored
+ * 					as int32 with a scale and an offset which cover the bounding box of the
+ * 					points, and the weight is omitted when all the points have the same
+ * 					weight. The worst-case quantization errors are measured and reported
+ * \param[in]       argc: The number of arguments that main was called (integer)
+ * \param[in]       argv: The vector of arguments (string) which contains
+ * 					the options, the name of the input file and the name of the output file
+ * \return			Zero on success, or one on failure
+ */
+int main(int argc, char *argv[])
+{
+	register int i;
+	int first;
+	long j, k, n;
+	double e;
+	char *out_name;
+	struct cart_coord buf[BLOCK], src[BLOCK], dec[BLOCK];
+	unsigned char rec[BLOCK * 16];
+	struct span sp;
+	struct data_file df, qf;
+	struct point_index idx;
+	struct quant_header qh;
+	struct options opt;
+	FILE *out;
+
+	if ((first = options(argc, argv, &opt)) < 0 || argc - first != 2)
+	{
+		printf("\nUsage: %s [-j threads] [-m] input.bin|.txt output.qbin\n", argv[0]);
+		exit(1);
+	}
+	out_name = argv[first + 1];
+	if (strrchr(out_name, '.') == NULL || strcmp(strrchr(out_name, '.'), ".qbin") != 0)
+	{
+		printf("\nThe name of the output file must end with .qbin\n");
+		exit(1);
+	}
+	if (open_data(argv[first], &df, &opt) != 0)
+	{
+		printf("\nCant open the file %s\n", argv[first]);
+		exit(1);
+	}
+	/* The bounding box of the points gives the scale and the offset of the coordinates */
+	quant_init(&df, &qh);
+	/* Writing the header, the records and, at the end, the header with the measured errors */
+	if ((out = fopen(out_name, "wb")) == NULL || fwrite(&qh, sizeof(qh), 1, out) != 1)
+	{
+		printf("\nCant write the file %s\n", out_name);
+		exit(1);
+	}
+	for (k = 0; (n = fetch_points(&df, k, (df.c - k < BLOCK) ? df.c - k : BLOCK, buf, &sp)) > 0; k += n)
+	{
+		for (j = 0; j < n; j++)
+		{
+			src[j].x = sp.x[j * sp.stride];
+			src[j].y = sp.y[j * sp.stride];
+			src[j].z = sp.z[j * sp.stride];
+			src[j].w = sp.w[j * sp.stride];
+		}
+		encode_points(src, n, &qh, rec);
+		if (fwrite(rec, qh.record, n, out) != (size_t)n)
+		{
+			printf("\nCant write the file %s\n", out_name);
+			exit(1);
+		}
+		decode_points(rec, n, &qh, dec);
+		for (j = 0; j < n; j++)
+		{
+			qh.error[0] = fmax(qh.error[0], fabs(dec[j].x - src[j].x));
+			qh.error[1] = fmax(qh.error[1], fabs(dec[j].y - src[j].y));
+			qh.error[2] = fmax(qh.error[2], fabs(dec[j].z - src[j].z));
+			qh.error[3] = fmax(qh.error[3], fabs(dec[j].w - src[j].w));
+		}
+	}
+	close_data(&df);
+	if (fseek(out, 0, SEEK_SET) != 0 || fwrite(&qh, sizeof(qh), 1, out) != 1 || fclose(out) != 0)
+	{
+		printf("\nCant write the file %s\n", out_name);
+		exit(1);
+	}
+	/* The index of the quantized file is calculated from the decoded points */
+	opt.io = IO_STDIO;
+	if (open_data(out_name, &qf, &opt) != 0)
+	{
+		printf("\nCant open the file %s\n", out_name);
+		exit(1);
+	}
+	index_data(&qf, &idx);
+	close_data(&qf);
+	if (write_index(out_name, &idx) != 0)
+		printf("\nWarning: cant write the index file of %s", out_name);
+	printf("\n%s -> %s", argv[first], out_name);
+	printf("\nPoints = %lld, %d bytes per point (%s weight)", idx.c, qh.record, (qh.record == 12) ? "common" : "float");
+	printf("\nScale = %.3e %.3e %.3e", qh.scale[0], qh.scale[1], qh.scale[2]);
+	for (i = 0, e = 0.0; i < 3; i++)
+		e = fmax(e, qh.error[i]);
+	printf("\nMaximum quantization error: x = %.3e, y = %.3e, z = %.3e, w = %.3e", qh.error[0], qh.error[1], qh.error[2], qh.error[3]);
+	printf("\nMaximum coordinate error = %.3e (bound %.3e)\n", e, 0.5 * fmax(qh.scale[0], fmax(qh.scale[1], qh.scale[2])));
+	return 0;
+}
@@ -0,0 +1,358 @@
+/**
+ * \file		ransac_fit.c
+ * \brief       Robust initial values by random sampling and consensus (RANSAC)
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/* A structure for the points of the pool, which are drawn from all the data files */
+struct pool {
+	double *x, *y, *z, *w;
+	long m;
+};
+
+/* A structure for the work of a thread: a range of hypotheses and its best hypothesis */
+struct hypotheses {
+	struct pool *pl;
+	long first, last;
+	double threshold;
+	double *d; /* The distances of the points of the pool (m doubles) */
+	double score;
+	type values[9];
+};
+
+/**
+ * \brief           A pseudo-random number generator (SplitMix64)
+ * \param[in,out]   s: The state of the generator
+ * \return			The next 64-bit number
+ */
+static unsigned long long splitmix(unsigned long long *s)
+{
+	unsigned long long z = (*s += 0x9E3779B97F4A7C15ULL);
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/**
+ * \brief           Finds the k-th smallest element of a vector (quickselect), reordering it
+ * \param[in,out]   a: The vector
+ * \param[in]       n: The number of elements
+ * \param[in]       k: The rank of the element (starting from zero)
+ * \return			The k-th smallest element
+ */
+static double select_kth(double *a, long n, long k)
+{
+	long lo = 0, hi = n - 1, i, j;
+	double pivot, tmp;
+
+	while (lo < hi)
+	{
+		pivot = a[(lo + hi) / 2];
+		for (i = lo, j = hi; i <= j;)
+		{
+			while (a[i] < pivot)
+				i++;
+			while (a[j] > pivot)
+				j--;
+			if (i <= j)
+			{
+				tmp = a[i];
+				a[i++] = a[j];
+				a[j--] = tmp;
+			}
+		}
+		if (k <= j)
+			hi = j;
+		else if (k >= i)
+			lo = i;
+		else
+			break;
+	}
+	return a[k];
+}
+
+/**
+ * \brief           Calculates the weighted Sampson distances |F| sqrt(w) / |grad F| of the
+ * 					points of the pool from an ellipsoid, which are the standardized
+ * 					misclosures of the adjustment multiplied by its standard deviation
+ * \param[in]       pl: The structure <pool> of the points
+ * \param[in]       values: Vector of the parameters of the ellipsoid
+ * \param[out]      d: Vector of the m distances
+ */
+static void distances(struct pool *pl, type *values, double *d)
+{
+	register long k;
+	struct model md;
+	double DX, DY, DZ, gx, gy, gz, F;
+
+	model_coefficients(values, &md);
+	for (k = 0; k < pl->m; k++)
+	{
+		DX = pl->x[k] - md.tx;
+		DY = pl->y[k] - md.ty;
+		DZ = pl->z[k] - md.tz;
+		gx = md.pxx * DX + md.pxy * DY + md.pxz * DZ;
+		gy = md.pxy * DX + md.pyy * DY + md.pyz * DZ;
+		gz = md.pxz * DX + md.pyz * DY + md.pzz * DZ;
+		F = DX * gx + DY * gy + DZ * gz - 1.0;
+		d[k] = fabs(F) * sqrt(pl->w[k]) / (2.0 * sqrt(gx * gx + gy * gy + gz * gz));
+		if (!isfinite(d[k]))
+			d[k] = HUGE_VAL;
+	}
+}
+
+/**
+ * \brief           Fits an ellipsoid algebraically to some points of the pool
+ * \param[in]       pl: The structure <pool> of the points
+ * \param[in]       idx: Vector of the indices of the points, or a null pointer for a mask
+ * \param[in]       mask: Vector of the flags of the points which are used (with idx null)
+ * \param[in]       n: The number of the indices
+ * \param[out]      values: Vector of the parameters of the ellipsoid
+ * \return			Zero, or -1 if the points do not give an ellipsoid
+ */
+static int fit_points(struct pool *pl, long *idx, bool *mask, long n, type *values)
+{
+	register long k;
+	register int i;
+	long j, l;
+	struct moments mom;
+	struct span sp;
+	double x[BLOCK], y[BLOCK], z[BLOCK];
+
+	mom.c = 0;
+	for (i = 0; i < 34; i++)
+		mom.a[i] = 0.0L;
+	sp.stride = 1;
+	sp.x = x;
+	sp.y = y;
+	sp.z = z;
+	sp.w = NULL;
+	for (k = 0, l = 0; k < (idx != NULL ? n : pl->m); k++)
+	{
+		if (idx == NULL && !mask[k])
+			continue;
+		j = (idx != NULL) ? idx[k] : k;
+		x[l] = pl->x[j];
+		y[l] = pl->y[j];
+		z[l] = pl->z[j];
+		/* The points are added to the moment sums in blocks */
+		if (++l == BLOCK)
+		{
+			sp.n = l;
+			moment_sums(&sp, &mom);
+			l = 0;
+		}
+	}
+	sp.n = l;
+	moment_sums(&sp, &mom);
+	if (mom.c < 9 || algebraic_fit(&mom, values) != 0)
+		return -1;
+	for (i = 0; i < 9; i++)
+		if (!isfinite(values[i]))
+			return -1;
+	return (values[3] > 0.0L && values[4] > 0.0L && values[5] > 0.0L) ? 0 : -1;
+}
+
+/**
+ * \brief           Fits and scores a range of hypotheses. Hypothesis h is the algebraic fit of
+ * 					RANSAC_SUBSET different points of the pool, drawn by a generator with the
+ * 					seed h, so that the hypotheses do not depend on the number of threads.
+ * 					With a threshold the score is the number of points of the pool whose
+ * 					distances are larger than it, else it is the median of the distances
+ * \param[in]       arg: A pointer to the structure <hypotheses> of the thread
+ * \return			A null pointer
+ */
+static void *hypotheses_worker(void *arg)
+{
+	struct hypotheses *hy = arg;
+	struct pool *pl = hy->pl;
+	register int i, j;
+	long h, k, idx[RANSAC_SUBSET];
+	unsigned long long state;
+	double score;
+	type values[9];
+
+	hy->score = HUGE_VAL;
+	for (h = hy->first; h < hy->last; h++)
+	{
+		state = RANSAC_SEED + h;
+		for (i = 0; i < RANSAC_SUBSET; i++)
+			do {
+				idx[i] = splitmix(&state) % pl->m;
+				for (j = 0; j < i && idx[j] != idx[i]; j++);
+			} while (j < i);
+		if (fit_points(pl, idx, NULL, RANSAC_SUBSET, values) != 0)
+			continue;
+		distances(pl, values, hy->d);
+		if (hy->threshold > 0.0)
+			for (k = 0, score = 0.0; k < pl->m; k++)
+				score += hy->d[k] > hy->threshold;
+		else
+			score = select_kth(hy->d, pl->m, pl->m / 2);
+		if (score < hy->score)
+		{
+			hy->score = score;
+			for (i = 0; i < 9; i++)
+				hy->values[i] = values[i];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * \brief           Calculates robust initial values for contaminated data. A pool of at most
+ * 					RANSAC_POOL points is drawn evenly from all the data files and many minimal
+ * 					subsets of it are fitted algebraically (function algebraic_fit()), in parallel.
+ * 					Every hypothesis is scored on the pool with the weighted Sampson distances:
+ * 					the number of outliers for a given threshold (RANSAC), or the median of the
+ * 					distances (least median of squares). The best hypothesis gives the robust
+ * 					scale s = 1.4826 (1 + 5 / (n - 9)) median of its n distances (within the
+ * 					threshold, if it is given) and the inliers of the pool (within the threshold
+ * 					or within RANSAC_K s), which are fitted algebraically again
+ * \param[in]       df: Vector of the structures <data_file> of the data files
+ * \param[in]       file_num: The number of the data files
+ * \param[out]      values: Vector of the initial values of the triaxial ellipsoid
+ * \param[out]      scale: The robust scale of the distances of the inliers
+ * \param[in]       opt: The run-time options (threads, hypotheses and threshold)
+ * \return			The number of inliers of the pool, or -1 if no hypothesis is an ellipsoid
+ */
+long ransac_fit(struct data_file *df, int file_num, type *values, type *scale, struct options *opt)
+{
+	register int i;
+	int threads = opt->threads;
+	long k, j, total = 0, m, inliers = 0;
+	struct cart_coord buf[BLOCK];
+	struct span sp;
+	struct pool pl;
+	double *d, limit;
+	bool *mask;
+	type best[9];
+
+	for (i = 0; i < file_num; i++)
+		total += df[i].c;
+	m = (total < RANSAC_POOL) ? total : RANSAC_POOL;
+	if (m < 2 * RANSAC_SUBSET)
+		return -1;
+	if (threads > opt->ransac)
+		threads = opt->ransac;
+	pl.m = m;
+	pl.x = malloc(4 * m * sizeof(double));
+	d = malloc((threads + 1) * m * sizeof(double));
+	mask = malloc(m * sizeof(bool));
+	if (pl.x == NULL || d == NULL || mask == NULL)
+	{
+		free(pl.x);
+		free(d);
+		free(mask);
+		return -1;
+	}
+	pl.y = pl.x + m;
+	pl.z = pl.y + m;
+	pl.w = pl.z + m;
+	/* Drawing the points of the pool at equal distances from all the points of the files */
+	for (k = 0, i = 0, j = 0; k < m; k++)
+	{
+		j = (long)((k + 0.5) * total / m);
+		for (i = 0; j >= df[i].c; i++)
+			j -= df[i].c;
+		if (fetch_points(&df[i], j, 1, buf, &sp) != 1)
+		{
+			pl.m = k;
+			break;
+		}
+		pl.x[k] = sp.x[0];
+		pl.y[k] = sp.y[0];
+		pl.z[k] = sp.z[0];
+		pl.w[k] = sp.w[0];
+	}
+	m = pl.m;
+	/* A pool cut short by a read error may be too small for distinct minimal subsets */
+	if (m < 2 * RANSAC_SUBSET)
+	{
+		free(pl.x);
+		free(d);
+		free(mask);
+		return -1;
+	}
+	/* Fitting and scoring the hypotheses, a range of them by every thread */
+	{
+		pthread_t tid[threads];
+		bool started[threads];
+		struct hypotheses hy[threads];
+
+		for (i = 0; i < threads; i++)
+		{
+			hy[i].pl = &pl;
+			hy[i].first = (long)i * opt->ransac / threads;
+			hy[i].last = (long)(i + 1) * opt->ransac / threads;
+			hy[i].threshold = opt->threshold;
+			hy[i].d = d + (i + 1) * m;
+			/* The first range is processed by the calling thread */
+			started[i] = i > 0 && pthread_create(&tid[i], NULL, hypotheses_worker, &hy[i]) == 0;
+		}
+		for (i = 0; i < threads; i++)
+		{
+			if (started[i])
+				pthread_join(tid[i], NULL);
+			else
+				hypotheses_worker(&hy[i]);
+		}
+		/* The best hypothesis (the first of equal ones, so that it does not depend on the threads) */
+		for (i = 1, j = 0; i < threads; i++)
+			if (hy[i].score < hy[j].score)
+				j = i;
+		if (hy[j].score < HUGE_VAL)
+		{
+			for (i = 0; i < 9; i++)
+				best[i] = hy[j].values[i];
+			inliers = m;
+		}
+	}
+	/* The robust scale and the inliers of the best hypothesis */
+	if (inliers > 0)
+	{
+		distances(&pl, best, d);
+		for (k = 0, j = 0; k < m; k++)
+			if (opt->threshold == 0.0 || d[k] <= opt->threshold)
+				d[m + j++] = d[k];
+	}
+	if (inliers > 0 && j > RANSAC_SUBSET)
+	{
+		*scale = 1.4826 * (1.0 + 5.0 / (j - RANSAC_SUBSET)) * select_kth(d + m, j, j / 2);
+		limit = (opt->threshold > 0.0) ? opt->threshold : RANSAC_K * *scale;
+		for (k = 0, inliers = 0; k < m; k++)
+			inliers += mask[k] = d[k] <= limit;
+		/* Fitting the inliers of the pool algebraically */
+		if (fit_points(&pl, NULL, mask, m, values) != 0)
+			for (i = 0; i < 9; i++)
+				values[i] = best[i];
+	}
+	else
+		inliers = -1;
+	free(pl.x);
+	free(d);
+	free(mask);
+	return inliers;
+}
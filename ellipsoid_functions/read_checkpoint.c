@@ -0,0 +1,87 @@
+/**
+ * \file		read_checkpoint.c
+ * \brief       Reading of the checkpoint of the sequential adjustments
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Reads a checkpoint file of the sequential adjustments, which was
+ * 					written by the function write_checkpoint(), and verifies its format
+ * 					and its checksum
+ * \param[in]       path: The name of the checkpoint file
+ * \param[out]      x: The solution
+ * \param[out]      names: The names of the absorbed data files (a vector of pointers
+ * 					into one block, both allocated; the caller frees names[0] and names)
+ * \param[out]      n: The number of the absorbed data files
+ * \return			Zero on success, -1 if the file does not exist, or -2 if it is invalid
+ */
+int read_checkpoint(char *path, struct solution *x, char ***names, int *n)
+{
+	register int i, q;
+	unsigned int crc, stored;
+	long long k;
+	char *block;
+	struct checkpoint_header hd;
+	FILE *fp;
+
+	if ((fp = fopen(path, "rb")) == NULL)
+		return -1;
+	if (fread(&hd, sizeof(hd), 1, fp) != 1 || memcmp(hd.magic, CKPT_MAGIC, sizeof(hd.magic)) != 0
+			|| hd.version != CKPT_VERSION || hd.files < 0 || hd.names < hd.files || hd.names > (1LL << 30))
+	{
+		fclose(fp);
+		return -2;
+	}
+	block = malloc(hd.names + 1);
+	*names = malloc((hd.files + 1) * sizeof(char *));
+	if (block == NULL || *names == NULL || fread(block, 1, hd.names, fp) != (size_t)hd.names
+			|| fread(&stored, sizeof(stored), 1, fp) != 1)
+	{
+		free(block);
+		free(*names);
+		fclose(fp);
+		return -2;
+	}
+	fclose(fp);
+	crc = crc32_update(crc32_update(0, &hd, sizeof(hd)), block, hd.names);
+	block[hd.names] = '\0';
+	/* Splitting the block of the names */
+	for (k = 0, i = 0; k < hd.names && i < hd.files; k += strlen(block + k) + 1)
+		(*names)[i++] = block + k;
+	(*names)[0] = block;
+	if (crc != stored || i != hd.files)
+	{
+		free(block);
+		free(*names);
+		return -2;
+	}
+	*n = hd.files;
+	x->r = hd.r;
+	for (i = 0; i < 9; i++)
+		x->x[i] = (type)hd.x[i][0] + hd.x[i][1];
+	for (q = 0; q < NPACK; q++)
+		x->Nbar[q] = (type)hd.Nbar[q][0] + hd.Nbar[q][1];
+	x->s02 = (type)hd.s02[0] + hd.s02[1];
+	return 0;
+}
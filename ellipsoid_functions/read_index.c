@@ -0,0 +1,57 @@
+/**
+ * \file		read_index.c
+ * \brief       Reading of the index file of a data file
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Reads the index file name.idx of a data file. The index is used
+ * 					only if its format is known and the size and the modification time
+ * 					of the data file are the same as when the index was written
+ * \param[in]       name: The name of the data file
+ * \param[out]      idx: The structure <point_index> of the file
+ * \return			Zero if a valid index was read, otherwise -1
+ */
+int read_index(char *name, struct point_index *idx)
+{
+	struct stat st;
+	char path[strlen(name) + 5];
+	size_t got;
+	FILE *fp;
+
+	if (stat(name, &st) != 0)
+		return -1;
+	sprintf(path, "%s.idx", name);
+	if ((fp = fopen(path, "rb")) == NULL)
+		return -1;
+	got = fread(idx, sizeof(struct point_index), 1, fp);
+	fclose(fp);
+	if (got != 1 || memcmp(idx->magic, INDEX_MAGIC, sizeof(idx->magic)) != 0)
+		return -1;
+	if (idx->version != INDEX_VERSION || idx->record != sizeof(struct cart_coord))
+		return -1;
+	if (idx->size != st.st_size || idx->mtime != st.st_mtime)
+		return -1;
+	return 0;
+}
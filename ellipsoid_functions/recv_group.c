@@ -0,0 +1,111 @@
+/**
+ * \file		recv_group.c
+ * \brief       Reading of a record of the distributed fitting
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Reads an unsigned integer of n bytes in little-endian order
+ * \param[in,out]   p: The bytes, advanced to the next one
+ * \param[in]       n: The number of bytes
+ * \return			The integer
+ */
+static unsigned long long get_int(const unsigned char **p, int n)
+{
+	register int i;
+	unsigned long long v = 0;
+
+	for (i = n - 1; i >= 0; i--)
+		v = (v << 8) | (*p)[i];
+	*p += n;
+	return v;
+}
+
+/**
+ * \brief           Reads a long double value which is stored as a pair of IEEE 754 doubles
+ * \param[in,out]   p: The bytes, advanced to the next value
+ * \return			The value
+ */
+static type get_value(const unsigned char **p)
+{
+	double d[2];
+	unsigned long long u;
+	register int i;
+
+	for (i = 0; i < 2; i++)
+	{
+		u = get_int(p, 8);
+		memcpy(&d[i], &u, sizeof(u));
+	}
+	return (type)d[0] + d[1];
+}
+
+/**
+ * \brief           Reads a record of the distributed fitting, which was written by the
+ * 					function send_group(), from a file descriptor (a socket or a file) and
+ * 					verifies its format and its checksum
+ * \param[in]       fd: The file descriptor
+ * \param[out]      rec: The record
+ * \return			Zero on success, -1 at the end of the input, or -2 if the record is invalid
+ */
+int recv_group(int fd, struct group_record *rec)
+{
+	register int i;
+	unsigned char buf[GROUP_RECORD];
+	const unsigned char *p = buf + 8;
+	size_t done = 0;
+	ssize_t got;
+	long long c;
+
+	while (done < sizeof(buf) && (got = read(fd, buf + done, sizeof(buf) - done)) > 0)
+		done += got;
+	if (done == 0)
+		return -1;
+	if (done < sizeof(buf) || memcmp(buf, GROUP_MAGIC, 8) != 0 || get_int(&p, 4) != GROUP_VERSION)
+		return -2;
+	rec->kind = get_int(&p, 4);
+	rec->shard = (int)get_int(&p, 4);
+	rec->iteration = (int)get_int(&p, 4);
+	rec->robust = get_int(&p, 4);
+	get_int(&p, 4);
+	rec->run = get_int(&p, 8);
+	c = (long long)get_int(&p, 8);
+	rec->g.c = c;
+	rec->mom.c = c;
+	for (i = 0; i < 9; i++)
+		rec->values[i] = get_value(&p);
+	rec->tuning = get_value(&p);
+	rec->scale = get_value(&p);
+	rec->g.weight = get_value(&p);
+	rec->g.sum_piwi2 = get_value(&p);
+	for (i = 0; i < 9; i++)
+		rec->g.U_bar[i] = get_value(&p);
+	for (i = 0; i < NPACK; i++)
+		rec->g.N_bar[i] = get_value(&p);
+	for (i = 0; i < 34; i++)
+		rec->mom.a[i] = get_value(&p);
+	if (get_int(&p, 4) != crc32_update(0, buf, GROUP_RECORD - 4) || rec->kind < REC_MOMENTS || rec->kind > REC_STOP || c < 0)
+		return -2;
+	return 0;
+}
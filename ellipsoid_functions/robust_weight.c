@@ -0,0 +1,54 @@
+/**
+ * \file		robust_weight.c
+ * \brief       Robust weight factors of the misclosures (Huber and Tukey biweight)
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Calculates the factor of the weight of a point from its standardized
+ * 					misclosure e = w sqrt(p) / s0, where s0 is the scale of the model.
+ * 					Huber: 1 for |e| <= k, else k / |e|. Tukey biweight: (1 - (e / k)^2)^2
+ * 					for |e| < k, else zero, so that the point is not used. Mask of the
+ * 					RANSAC pre-fit: 1 for |e| <= k, else zero
+ * \param[in]       e2: The squared standardized misclosure
+ * \param[in]       md: The coefficients of the linearized model (weight function and tuning constant k)
+ * \return			The factor of the weight of the point (between zero and one)
+ */
+type robust_weight(type e2, struct model *md)
+{
+	type k2 = md->tuning * md->tuning, t;
+
+	if (md->robust == ROBUST_HUBER)
+		return (e2 <= k2) ? 1.0L : md->tuning / sqrt(e2);
+	if (md->robust == ROBUST_TUKEY)
+	{
+		if (e2 >= k2)
+			return 0.0L;
+		t = 1.0L - e2 / k2;
+		return t * t;
+	}
+	if (md->robust == ROBUST_MASK)
+		return (e2 <= k2) ? 1.0L : 0.0L;
+	return 1.0L;
+}
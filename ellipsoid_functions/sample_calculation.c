@@ -0,0 +1,134 @@
+/**
+ * \file		sample_calculation.c
+ * \brief       Calculation of the matrix N and the vector u from a stratified subsample of a data file
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/* A structure for the work of a thread: a range of strata of a data file and its contribution */
+struct strata {
+	struct data_file *df;
+	long first, last; /* The strata of the thread */
+	long count; /* The number of strata of the file */
+	long m; /* The number of points of the subsample */
+	struct model *md;
+	struct group part;
+};
+
+/**
+ * \brief           Accumulates the points of a range of strata into the private structure
+ * 					<group> of the thread. Stratum s covers the points from s c / S to
+ * 					(s + 1) c / S of the file and its first (s + 1) m / S - s m / S points
+ * 					are used, so that the subsample is spread evenly over the file
+ * \param[in]       arg: A pointer to the structure <strata> of the thread
+ * \return			A null pointer
+ */
+static void *strata_worker(void *arg)
+{
+	struct strata *st = arg;
+	struct cart_coord buf[BLOCK];
+	struct span sp;
+	long s, i, n, first, size;
+
+	for (s = st->first; s < st->last; s++)
+	{
+		first = s * st->df->c / st->count;
+		size = (s + 1) * st->m / st->count - s * st->m / st->count;
+		for (i = 0; i < size; i += n)
+		{
+			if ((n = fetch_points(st->df, first + i, size - i, buf, &sp)) <= 0)
+				break;
+			st->md->kernel(&sp, st->md, &st->part);
+		}
+	}
+	return NULL;
+}
+
+/**
+ * \brief           Calculates the matrix N and the vector u from a stratified subsample of
+ * 					m points of a data file: the file is divided into strata of equal size,
+ * 					one for every BLOCK points of the subsample, and the first points of
+ * 					every stratum are used. The strata are read as whole blocks, so that the
+ * 					cost of a pass is proportional to the subsample. The strata are split
+ * 					among the threads, whose partial results are added by the function summary()
+ * \param[in]       df: The structure <data_file> of the data file
+ * \param[in]       values: Vector of the parameters of the linearization
+ * \param[in]       opt: The run-time options (threads and kernel)
+ * \param[in]       m: The number of points of the subsample (all the points if m >= c)
+ * \return			A structure of type <group> which contains matrices
+ * 					and elements for the subsample of the group of measurements
+ */
+struct group sample_calculation(struct data_file *df, type *values, struct options *opt, long m)
+{
+	register int i;
+	int threads = opt->threads;
+	long count;
+	struct model md;
+	struct group matr;
+
+	if (m >= df->c)
+		return direct_calculation(df, values, opt);
+	/* Calculating the coefficients of the linearized model */
+	model_coefficients(values, &md);
+	select_kernel(&md, opt);
+	count = (m + BLOCK - 1) / BLOCK;
+	/* Every thread must take at least MINRANGE points */
+	if (threads > m / MINRANGE)
+		threads = m / MINRANGE;
+	if (threads < 1)
+		threads = 1;
+	{
+		pthread_t tid[threads];
+		bool started[threads];
+		struct strata st[threads];
+		struct group parts[threads];
+
+		for (i = 0; i < threads; i++)
+		{
+			st[i].df = df;
+			st[i].md = &md;
+			st[i].count = count;
+			st[i].m = m;
+			st[i].first = i * count / threads;
+			st[i].last = (i + 1) * count / threads;
+			zeros(&st[i].part.N_bar[0], NPACK, 1);
+			zeros(&st[i].part.U_bar[0], 9, 1);
+			st[i].part.sum_piwi2 = 0.0L;
+			st[i].part.weight = 0.0L;
+			st[i].part.c = 0;
+			/* The first strata are processed by the calling thread */
+			started[i] = i > 0 && pthread_create(&tid[i], NULL, strata_worker, &st[i]) == 0;
+		}
+		for (i = 0; i < threads; i++)
+		{
+			if (started[i])
+				pthread_join(tid[i], NULL);
+			else
+				strata_worker(&st[i]);
+		}
+		for (i = 0; i < threads; i++)
+			parts[i] = st[i].part;
+		matr = summary(parts, threads);
+	}
+	return matr;
+}
@@ -0,0 +1,42 @@
+/**
+ * \file		select_kernel.c
+ * \brief       Selection of the accumulation kernel
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Selects the kernel which accumulates the matrix N and the vector u:
+ * 					the double precision vector kernel or the long double one, and the
+ * 					robust weight function, which is used when the options have a scale
+ * 					(the standard deviation of the previous iteration)
+ * \param[in,out]   md: The structure <model> which receives the kernel
+ * \param[in]       opt: The run-time options
+ */
+void select_kernel(struct model *md, struct options *opt)
+{
+	md->kernel = opt->simd ? accumulate_simd : accumulate;
+	md->robust = (opt->scale > 0.0L) ? opt->robust : ROBUST_NONE;
+	md->tuning = opt->tuning;
+	md->iscale2 = (opt->scale > 0.0L) ? 1.0L / (opt->scale * opt->scale) : 0.0L;
+}
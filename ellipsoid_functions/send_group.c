@@ -0,0 +1,108 @@
+/**
+ * \file		send_group.c
+ * \brief       Writing of a record of the distributed fitting
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Stores an unsigned integer of n bytes in little-endian order
+ * \param[out]      p: The bytes
+ * \param[in]       v: The integer
+ * \param[in]       n: The number of bytes
+ * \return			The next byte
+ */
+static unsigned char *put_int(unsigned char *p, unsigned long long v, int n)
+{
+	register int i;
+
+	for (i = 0; i < n; i++, v >>= 8)
+		*p++ = v & 0xFF;
+	return p;
+}
+
+/**
+ * \brief           Stores a long double value as a pair of IEEE 754 doubles (hi, lo)
+ * \param[out]      p: The bytes
+ * \param[in]       v: The value
+ * \return			The next byte
+ */
+static unsigned char *put_value(unsigned char *p, type v)
+{
+	double d[2];
+	unsigned long long u;
+	register int i;
+
+	d[0] = v;
+	d[1] = v - d[0];
+	for (i = 0; i < 2; i++)
+	{
+		memcpy(&u, &d[i], sizeof(u));
+		p = put_int(p, u, 8);
+	}
+	return p;
+}
+
+/**
+ * \brief           Writes a record of the distributed fitting into a file descriptor (a
+ * 					socket or a file) in the portable format: the identifier GROUP_MAGIC,
+ * 					the version, the integers in little-endian order, the long double values
+ * 					as pairs of doubles (the matrix N as its upper triangle) and a CRC-32
+ * 					checksum, GROUP_RECORD bytes in total
+ * \param[in]       fd: The file descriptor
+ * \param[in]       rec: The record
+ * \return			Zero on success, or -1 if the record cannot be written
+ */
+int send_group(int fd, struct group_record *rec)
+{
+	register int i;
+	unsigned char buf[GROUP_RECORD], *p = buf;
+	size_t done = 0;
+	ssize_t got;
+
+	memcpy(p, GROUP_MAGIC, 8);
+	p = put_int(p + 8, GROUP_VERSION, 4);
+	p = put_int(p, rec->kind, 4);
+	p = put_int(p, rec->shard, 4);
+	p = put_int(p, rec->iteration, 4);
+	p = put_int(p, rec->robust, 4);
+	p = put_int(p, 0, 4);
+	p = put_int(p, rec->run, 8);
+	p = put_int(p, (rec->kind == REC_MOMENTS) ? rec->mom.c : rec->g.c, 8);
+	for (i = 0; i < 9; i++)
+		p = put_value(p, rec->values[i]);
+	p = put_value(p, rec->tuning);
+	p = put_value(p, rec->scale);
+	p = put_value(p, rec->g.weight);
+	p = put_value(p, rec->g.sum_piwi2);
+	for (i = 0; i < 9; i++)
+		p = put_value(p, rec->g.U_bar[i]);
+	for (i = 0; i < NPACK; i++)
+		p = put_value(p, rec->g.N_bar[i]);
+	for (i = 0; i < 34; i++)
+		p = put_value(p, rec->mom.a[i]);
+	put_int(p, crc32_update(0, buf, p - buf), 4);
+	while (done < sizeof(buf) && (got = write(fd, buf + done, sizeof(buf) - done)) > 0)
+		done += got;
+	return (done == sizeof(buf)) ? 0 : -1;
+}
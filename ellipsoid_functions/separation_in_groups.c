@@ -29,63 +29,189 @@
  * \brief           Fitting a triaxial ellipsoid by applying the separation in groups (of measurements) technique
  * \param[in]       argc: The number of arguments that main was called (integer)
  * \param[in]       argv: The vector of arguments (string) which
- * 					contains the names of the data files (binary files)
+ * 					contains the options and the names of the data files (binary files)
  * \return			An integer value equal to zero
  */
 int main(int argc, char *argv[])
 {
 	register int i, j;
-	int c, n, m, r, t = argc - 1, iteration;
-	type in_val[9], ds[9], N_inv[9][9], Vx[9][9];
-	type uTds, sigma0i, sigma0ip1, stx, sty, stz, sax, say, saz, sthetax, sthetay, sthetaz;
-	FILE *files[t];
-	struct group mat[t];
+	int t, first, iteration, rc, coarse = 0;
+	long c, n, m, r;
+	type in_val[9], ds[9], noise[9], N_inv[9][9], Vx[9][9];
+	type uTds, scale, diff, sum, size, level, weight, sigma0ip1, stx, sty, stz, sax, say, saz, sthetax, sthetay, sthetaz;
 	struct group final_mat;
+	struct ldl f;
+	struct adjustment adj;
+	struct options opt;
+	struct profile prof;
+	struct stage_timer tm;
+	double *arena = NULL, start = clock_seconds(CLOCK_MONOTONIC);
+	long long total = 0, sampled = 0;
+	long inliers = 0;
+	double fraction, target;
+	bool within;
 	
+	/* Reading the options of the command line by calling the function options() */
+	if ((first = options(argc, argv, &opt)) < 0 || (t = argc - first) < 1)
+	{
+		printf("\nUsage: %s [-j threads] [-m] [-c MB] [-s | -V] [-S nbuf [-B points]] [-T tol] [-X tol] [-I iterations] [-L halving|lm] [-F fraction] [-r huber|tukey[:k]] [-A hypotheses[:threshold]] [-P report.json [-H]] file1.bin|.txt [file2.bin|.txt ...]\n", argv[0]);
+		exit(1);
+	}
+	struct data_file files[t];
+	struct group mat[t];
 	/* Sorting the names of the included data files (binary files) in alphabetical order */
-	alpha_sort(argv, argc);
+	alpha_sort(&argv[first - 1], t + 1);
+	/* Starting the instrumentation by calling the function profile_init() */
+	if (opt.profile != NULL)
+	{
+		if (profile_init(&prof, files, t, opt.perf) != 0)
+			printf("\nWarning: the hardware counters are not available");
+		opt.prof = &prof;
+	}
 	/* Data Files control */
+	stage_begin(opt.prof, &tm);
 	for (i = 0; i < t; i++)
-		if((files[i] = fopen(argv[i + 1], "rb")) == NULL)
+	{
+		if(open_data(argv[first + i], &files[i], &opt) != 0)
 		{
-			printf("\nCant open the file %s", argv[i + 1]);
+			printf("\nCant open the file %s", argv[first + i]);
 			exit(1);
 		}
+		if(files[i].tail != 0)
+			printf("\nWarning: the last %d bytes of the file %s are not a complete point", files[i].tail, argv[first + i]);
+		if(files[i].bad != 0)
+			printf("\nWarning: %ld invalid lines of the file %s are not used", files[i].bad, argv[first + i]);
+		total += files[i].c;
+	}
+	/* Loading the points into the cache by calling the function load_cache() */
+	if (opt.cache > 0)
+	{
+		arena = load_cache(files, t, (size_t)opt.cache << 20);
+		for (i = 0, j = 0; i < t; i++)
+			j += files[i].x != NULL;
+		if (j < t)
+			printf("\nWarning: %d of %d files fit in the cache of %ld MB, the rest are read in every pass", j, t, opt.cache);
+	}
+	stage_end(opt.prof, PROF_OPEN, &tm, total);
+	/* Calculating robust initial values for contaminated data by calling the function ransac_fit(),
+	 * whose inliers are kept by the mask weights unless another weight function is given */
+	stage_begin(opt.prof, &tm);
+	if (opt.ransac > 0 && (inliers = ransac_fit(files, t, &in_val[0], &scale, &opt)) > 0)
+	{
+		c = total;
+		printf("\nRANSAC pre-fit: %ld hypotheses, %ld of %lld points of the pool are inliers, robust scale = %.6Lf", opt.ransac, inliers, total < RANSAC_POOL ? total : RANSAC_POOL, scale);
+		opt.scale = scale;
+		if (opt.robust == ROBUST_NONE)
+		{
+			opt.robust = ROBUST_MASK;
+			opt.tuning = MASK_K;
+		}
+	}
 	/* Calculating the total number of points and the initial values by calling the function initial_values() */
-	c = initial_values(files, t, &in_val[0]);
+	else if ((c = initial_values(files, t, &in_val[0], &opt)) < 0)
+	{
+		printf("\n\t Error in function Initial values , e = 0\n");
+		exit(1);
+	}
+	else if (opt.ransac > 0)
+		printf("\nWarning: the RANSAC pre-fit found no ellipsoid, the initial values are algebraic");
+	stage_end(opt.prof, PROF_INITIAL, &tm, c);
 	/* Printing the initial values of the triaxial ellipsoid */
 	display(&in_val[0], 9, 1, 4, "Initial Values");
+	/* Comparing the vector kernel with the long double one by calling the function validate_kernel() */
+	if (opt.validate)
+	{
+		diff = validate_kernel(files, t, &in_val[0], &opt);
+		printf("\nValidation of the %s kernel: maximum normalized difference = %.3Le (tolerance %.0e)", simd_name(), diff, SIMDTOL);
+		if (diff > SIMDTOL)
+		{
+			printf("\nThe long double kernel is used");
+			opt.simd = false;
+		}
+	}
 	n = 3 * c; /* Total number of measurements */
 	m = 9 + 2 * c; /* Total number of unknowns */
 	r = n - m; /* Degrees of freedom */
-	iteration = 0;
-	sigma0i = 1.0L;
-	sigma0ip1 = 2.0L;
-	/* Iterative adjustment procedure */
-	do {
-		sigma0i = sigma0ip1;
-		for (i = 0; i < t; i++)
-			mat[i] = direct_calculation(files[i], &in_val[0]);
-				
-		final_mat = summary(mat, t);	
-		cholesky(&final_mat.N_bar[0][0], &N_inv[0][0], 9);
-		multiply(&N_inv[0][0], &final_mat.U_bar[0], &ds[0], 9, 9, 1);
-		for(i = 0; i < 9; i++)
-			in_val[i] += ds[i];
-			
+	/* Coarse iterations on stratified subsamples of the groups by calling the function sample_calculation().
+	 * When the correction is within the noise of the subsample from whose solution it starts (the standard
+	 * deviations of the parameters from the subsample of the previous pass, by the margin COARSE_MARGIN),
+	 * the subsample grows to the size from which the first pass over all the points converges. The passes
+	 * over all the points start when that size is reached or it would contain all the points */
+	for (fraction = opt.coarse; fraction > 0.0 && fraction < 1.0 && coarse < COARSE_PASSES; coarse++)
+	{
+		stage_begin(opt.prof, &tm);
+		for (i = 0, sampled = 0; i < t; i++)
+		{
+			mat[i] = sample_calculation(&files[i], &in_val[0], &opt, (fraction * files[i].c > BLOCK) ? (long)ceil(fraction * files[i].c) : BLOCK);
+			sampled += mat[i].c;
+		}
+		stage_end(opt.prof, PROF_DIRECT, &tm, sampled);
+		final_mat = summary(mat, t);
+		if (ldl_factor(&final_mat.N_bar[0], &f) != 0)
+			break;
+		ldl_solve(&f, &final_mat.U_bar[0], &ds[0]);
 		multiply(&final_mat.U_bar[0], &ds[0], &uTds, 1, 9, 1);
-		sigma0ip1 = sqrt((final_mat.sum_piwi2 - uTds) / r);	
-		iteration++;
-	} while(MYABS(sigma0i - sigma0ip1) > CONVTOL && iteration < 10);
+		sigma0ip1 = sqrt((final_mat.sum_piwi2 - uTds) / (final_mat.weight - 9));
+		if (opt.robust == ROBUST_HUBER || opt.robust == ROBUST_TUKEY)
+			opt.scale = sigma0ip1;
+		ldl_inverse(&f, &N_inv[0][0], false);
+		/* The largest standard deviation, relative to the largest semi-axis (rad for the angles) */
+		for (i = 3, size = 0.0L; i < 6; i++)
+			if (MYABS(in_val[i]) > size)
+				size = MYABS(in_val[i]);
+		for (i = 0, sum = level = 0.0L, within = true; i < 9; i++)
+		{
+			sum += MYABS(ds[i]);
+			if (coarse == 0)
+				noise[i] = sigma0ip1 * sqrt(N_inv[i][i]);
+			within = within && ds[i] * ds[i] <= COARSE_MARGIN * noise[i] * noise[i];
+			noise[i] = sigma0ip1 * sqrt(N_inv[i][i]);
+			if (noise[i] / (i < 6 ? size : 1.0L) > level)
+				level = noise[i] / (i < 6 ? size : 1.0L);
+		}
+		if (!isfinite(sum) || !isfinite(sigma0ip1))
+			break;
+		for (i = 0; i < 9; i++)
+			in_val[i] += ds[i];
+		profile_iteration(opt.prof, 0, coarse + 1, sigma0ip1, &ds[0]);
+		if (!within)
+			continue;
+		/* The correction of all the points from the solution of a fraction f of them is the noise of the
+		 * subsample times sqrt(1 - f), and it changes the standard deviation by about 9 sigma0 (1 / f - 1) / (2 r).
+		 * Both must be within the tolerances by the margin COARSE_MARGIN */
+		weight = final_mat.weight * total / sampled;
+		target = COARSE_MARGIN * 9.0L * sigma0ip1 / (COARSE_MARGIN * 9.0L * sigma0ip1 + 2.0L * weight * opt.tolerance);
+		if (opt.step_tol > 0.0L && COARSE_MARGIN * (level / opt.step_tol) * (level / opt.step_tol) * sampled / total > target)
+			target = COARSE_MARGIN * (level / opt.step_tol) * (level / opt.step_tol) * sampled / total;
+		fraction = (target <= (double)sampled / total) ? 1.0 : target;
+	}
+	/* Iterative adjustment procedure by calling the function iterate_adjustment() */
+	for (i = 0; i < 9; i++)
+		adj.x[i] = in_val[i];
+	/* After the coarse iterations the first pass over all the points can converge alone */
+	adj.warm = coarse > 0;
+	if ((rc = iterate_adjustment(files, t, &adj, &opt, mat)) != 0)
+	{
+		printf((rc == -1) ? "\nNot enough memory for the tasks of the scheduler" : "\nThe normal matrix is not positive definite");
+		exit(1);
+	}
+	for (i = 0; i < 9; i++)
+		in_val[i] = adj.x[i];
+	sigma0ip1 = adj.sigma0ip1;
+	iteration = adj.iteration;
 	
 	/* Closing all the data files */
 	for (i = 0; i < t; i++)
-		fclose(files[i]);
+		close_data(&files[i]);
+	free(arena);
 	
-	/* Calculating the variance-covariance matrix */
+	/* Calculating the variance-covariance matrix from the factorization of the last iteration */
+	stage_begin(opt.prof, &tm);
+	ldl_inverse(&adj.f, &N_inv[0][0], true);
 	for(i = 0; i < 9; i++)
 		for(j = 0; j < 9; j++)
 			Vx[i][j] = sigma0ip1 * sigma0ip1 * N_inv[i][j];
+	stage_end(opt.prof, PROF_COVARIANCE, &tm, 0);
 	
 	/* Calculating each parameter's std */		
 	stx = sqrt(Vx[0][0]);
@@ -104,13 +230,19 @@ int main(int argc, char *argv[])
 	/* Printing results */
 	printf("\nNumber of files = %d\nIncluded files :", t);
 	for (i = 0; i < t; i++)
-		printf("\n%s", argv[i + 1]);
-	printf("\n\nc = %d points", c);
-	printf("\nn = %d measurements", n);
-	printf("\nm = %d unknowns", m);
-	printf("\nr = %d degrees of freedom", r);
+		printf("\n%s", argv[first + i]);
+	printf("\n\nc = %ld points", c);
+	printf("\nn = %ld measurements", n);
+	printf("\nm = %ld unknowns", m);
+	printf("\nr = %ld degrees of freedom", r);
+	if (opt.robust != ROBUST_NONE)
+		printf("\nEffective r = %.1Lf degrees of freedom (%s weights, k = %.3Lf)", adj.g.weight - 9, opt.robust == ROBUST_HUBER ? "Huber" : opt.robust == ROBUST_TUKEY ? "Tukey" : "RANSAC mask", opt.tuning);
 	printf("\nIterations = %d", iteration);
-	printf("\nExecution time = %ld [s]", clock() / CLOCKS_PER_SEC);
+	if (opt.damping != DAMP_NONE)
+		printf(" (%d rejected steps)", adj.dm.rejected);
+	if (coarse > 0)
+		printf("\nCoarse iterations = %d (%lld points at the last one)", coarse, sampled);
+	printf("\nExecution time = %.3f [s] (wall), %.3f [s] (CPU)", clock_seconds(CLOCK_MONOTONIC) - start, clock_seconds(CLOCK_PROCESS_CPUTIME_ID));
 	printf("\n\nElipsoid Parameters:");
 	printf("\ntx = %-.4Lf +/- %-.5Lf [m]", in_val[0], stx);
 	printf("\nty = %-.4Lf +/- %-.5Lf [m]", in_val[1], sty);
@@ -123,6 +255,13 @@ int main(int argc, char *argv[])
 	printf("\ntheta_z = %-.4Lf +/- %-.5Lf [deg]", in_val[8], sthetaz);
 	printf("\ns0_aposteriori = +/- %-.4Lf [m]", sigma0ip1);
 	display(&Vx[0][0], 9, 9, 7, "Vx");
+	/* Writing the instrumentation report by calling the function write_profile() */
+	if (opt.prof != NULL)
+	{
+		if (write_profile(opt.profile, &prof, argv[0], &opt) != 0)
+			printf("\nWarning: cant write the report %s", opt.profile);
+		profile_free(&prof);
+	}
 	return 0;
 }
 
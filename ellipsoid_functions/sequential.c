@@ -28,29 +28,47 @@
 /**
  * \brief           Given an initial solution, it calculates the
  * 					revised solution by applying the sequential
- * 					adjustment technique
- * \param[in]       file: The data file
+ * 					adjustment technique. The measurements of k groups
+ * 					are added at once: their contributions are calculated
+ * 					concurrently at the same parameters x1 (function
+ * 					group_calculation(), which shares their points among
+ * 					the threads) and added as one group
+ * \param[in]       df: Vector of the k structures <data_file> of the data files
+ * \param[in]       k: The number of the added groups
  * \param[in]       x1: The structure <solution> which contain
  * 					the previous solution of the sequential adjustment
+ * \param[in]       opt: The run-time options (threads, kernel and instrumentation)
+ * \param[out]      added: Vector of the k structures <group> of the added measurements
+ * 					(linearized at x1), which are kept by the sliding window, or a null pointer
  * \return			The revised solution of the sequential adjustment
  */
-struct solution sequential(FILE *file, struct solution x1)
+struct solution sequential(struct data_file *df, int k, struct solution x1, struct options *opt, struct group *added)
 {
-	struct group M2;
+	struct group M[k], M2;
 	struct solution x;
-	type invNbar[9][9], dx1[9], u2Nu2 = 0.0L;
-	register int i, j;
+	struct ldl f;
+	struct stage_timer tm;
+	type dx1[9], u2Nu2 = 0.0L;
+	long long points = 0;
+	register int i;
 	
 	/* Calculating the matrix N2 and the vector u2 of the added measurements */
-	M2 = direct_calculation(file, &x1.x[0]);
+	stage_begin(opt->prof, &tm);
+	if (k == 1 || opt->threads == 1 || group_calculation(df, k, &x1.x[0], opt, M) != 0)
+		for (i = 0; i < k; i++)
+			M[i] = direct_calculation(&df[i], &x1.x[0], opt);
+	M2 = summary(M, k);
+	for (i = 0; i < k; i++)
+		points += df[i].c;
+	stage_end(opt->prof, PROF_DIRECT, &tm, points);
 	/* Calculating the final matrix N (N = N1 + N2) */
-	for (i = 0; i < 9; i++)
-		for(j = 0; j < 9; j++)
-			x.Nbar[i][j] = x1.Nbar[i][j] + M2.N_bar[i][j];
-	/* Inversion of the matrix N by calling the function cholesky() */
-	cholesky(&x.Nbar[0][0], &invNbar[0][0], 9);
-	/* Multiplication of the N and u2 matrices by calling the function multiply() */
-	multiply(&invNbar[0][0], &M2.U_bar[0], &dx1[0], 9, 9, 1);
+	memcpy(x.Nbar, x1.Nbar, sizeof(x.Nbar));
+	packed_axpy(&x.Nbar[0], 1.0L, &M2.N_bar[0]);
+	/* Solving N dx1 = u2 by calling the functions ldl_factor() and ldl_solve() */
+	stage_begin(opt->prof, &tm);
+	ldl_factor(&x.Nbar[0], &f);
+	ldl_solve(&f, &M2.U_bar[0], &dx1[0]);
+	stage_end(opt->prof, PROF_SOLVE, &tm, 0);
 	x.r = x1.r + M2.c; /* Degrees of freedom */
 	/* Calculation of the revised solution */
 	for (i = 0; i < 9; i++)
@@ -60,6 +78,9 @@ struct solution sequential(FILE *file, struct solution x1)
 	}
 	/* Calculating the revised a-posteriori variance factor */
 	x.s02 = (x1.r * x1.s02 - u2Nu2 + M2.sum_piwi2) / x.r;
+	if (added != NULL)
+		for (i = 0; i < k; i++)
+			added[i] = M[i];
 	return x;
 }
 
@@ -30,85 +30,232 @@
  * 					the sequential adjustments technique
  * \param[in]       argc: The number of arguments that main was called (integer)
  * \param[in]       argv: The vector of the arguments (string) which
- * 					contains the names of the data files (binary files)
+ * 					contains the options and the names of the data files (binary files)
  * \return			An integer value equal to zero
  */
 int main(int argc, char *argv[])
 {
-	int c, n, m, t = argc - 1, iteration;
+	int t, first, iteration, k = 0, done = 0, rc = -1;
+	long c = 0, n, m;
 	register int i, j;
-	FILE *files[t];
-	type in_val[9], ds[9], N_inv[9][9];
+	type in_val[9], N_inv[9][9], dx[9];
 	type Vx[9][9];
-	type uTds, sigma0i, sigma0ip1, stx, sty, stz, sax, say, saz, sthetax, sthetay, sthetaz;
+	type diff, sigma0ip1, stx, sty, stz, sax, say, saz, sthetax, sthetay, sthetaz;
 	struct solution x, x1;
-	struct group mat;
+	struct ldl f;
+	struct options opt;
+	struct profile prof;
+	struct stage_timer tm;
+	double *arena = NULL, start = clock_seconds(CLOCK_MONOTONIC);
+	long long total = 0;
+	char **absorbed = NULL, **names;
+	int head = 0, count = 0, b, l;
+	struct window_group *win = NULL;
 	
+	/* Reading the options of the command line by calling the function options() */
+	if ((first = options(argc, argv, &opt)) < 0 || (t = argc - first) < 1)
+	{
+		printf("\nUsage: %s [-j threads] [-m] [-c MB] [-s | -V] [-S nbuf [-B points]] [-T tol] [-X tol] [-I iterations] [-L halving|lm] [-K groups] [-C checkpoint [-N groups] [-R]] [-P report.json [-H]] file1.bin|.txt [file2.bin|.txt ...]\n", argv[0]);
+		exit(1);
+	}
+	if (opt.robust != ROBUST_NONE)
+	{
+		printf("\nThe robust estimation (-r) is available only in the separation in groups\n");
+		exit(1);
+	}
+	if (opt.ransac > 0)
+	{
+		printf("\nThe RANSAC pre-fit (-A) is available only in the separation in groups\n");
+		exit(1);
+	}
 	/* Sorting the names of the included data files (binary files) in alphabetical order */
-	alpha_sort(argv, argc);
+	alpha_sort(&argv[first - 1], t + 1);
+	/* Reading the checkpoint by calling the function read_checkpoint() and removing the absorbed files */
+	if (opt.resume && (rc = read_checkpoint(opt.checkpoint, &x1, &absorbed, &k)) == -2)
+	{
+		printf("\nThe checkpoint %s is invalid\n", opt.checkpoint);
+		exit(1);
+	}
+	if (opt.resume && rc == -1)
+		printf("\nWarning: the checkpoint %s does not exist, the adjustment starts from the first group", opt.checkpoint);
+	for (i = 0, n = 0; i < t; i++)
+	{
+		for (j = 0; j < k && strcmp(argv[first + i], absorbed[j]) != 0; j++);
+		if (j == k)
+			argv[first + n++] = argv[first + i];
+	}
+	t = n;
+	/* The names of the absorbed files of the next checkpoints */
+	if ((names = malloc((k + t + 1) * sizeof(char *))) == NULL)
+		exit(1);
+	for (i = 0; i < k; i++)
+		names[i] = absorbed[i];
+	struct data_file files[t + 1];
+	struct group added[opt.batch];
+	/* Starting the instrumentation by calling the function profile_init() */
+	if (opt.profile != NULL)
+	{
+		if (profile_init(&prof, files, t, opt.perf) != 0)
+			printf("\nWarning: the hardware counters are not available");
+		opt.prof = &prof;
+	}
 	/* File read control */
+	stage_begin(opt.prof, &tm);
 	for (i = 0; i < t; i++)
-		if((files[i] = fopen(argv[i + 1], "rb")) == NULL)
+	{
+		if(open_data(argv[first + i], &files[i], &opt) != 0)
 		{
-			printf("\n\tCant open the file %s", argv[i + 1]);
+			printf("\n\tCant open the file %s", argv[first + i]);
 			exit(1);
 		}
+		if(files[i].tail != 0)
+			printf("\nWarning: the last %d bytes of the file %s are not a complete point", files[i].tail, argv[first + i]);
+		if(files[i].bad != 0)
+			printf("\nWarning: %ld invalid lines of the file %s are not used", files[i].bad, argv[first + i]);
+		total += files[i].c;
+	}
+	/* Loading the points into the cache by calling the function load_cache() */
+	if (opt.cache > 0)
+	{
+		arena = load_cache(files, t, (size_t)opt.cache << 20);
+		for (i = 0, j = 0; i < t; i++)
+			j += files[i].x != NULL;
+		if (j < t)
+			printf("\nWarning: %d of %d files fit in the cache of %ld MB, the rest are read in every pass", j, t, opt.cache);
+	}
+	stage_end(opt.prof, PROF_OPEN, &tm, total);
 	/* Calculating the number of points of the first group and the initial (of the first solution) values by calling the function initial_values() */
-	c = initial_values(files, 1, &in_val[0]);
-	x1.r = c - 9;
-	iteration = 0;
-	sigma0i = 1.0L;
-	sigma0ip1 = 2.0L;
-	/* Iterative adjustment procedure (only for the first group) */
-	do {
-		sigma0i = sigma0ip1;
-		mat = direct_calculation(files[0], &in_val[0]);		
-		cholesky(&mat.N_bar[0][0], &N_inv[0][0], 9);
-		multiply(&N_inv[0][0], &mat.U_bar[0], &ds[0], 9, 9, 1);
-		multiply(&mat.U_bar[0], &ds[0], &uTds, 1, 9, 1);
-		sigma0ip1 = sqrt((mat.sum_piwi2 - uTds) / x1.r);
-		
-		for(i = 0; i < 9; i++)
-			in_val[i] += ds[i];
-		rewind(files[0]);
-		iteration++;
-	} while(MYABS(sigma0i - sigma0ip1) > CONVTOL && iteration < 10);
-	for (i = 0; i < 9; i++)
+	if (rc == 0)
+		for (i = 0; i < 9; i++)
+			in_val[i] = x1.x[i];
+	else if (t > 0)
 	{
-		for (j = 0; j < 9; j++)
-			x1.Nbar[i][j] = mat.N_bar[i][j];
-		x1.x[i] = in_val[i];
+		stage_begin(opt.prof, &tm);
+		if ((c = initial_values(files, 1, &in_val[0], &opt)) < 0)
+		{
+			printf("\n\t Error in function Initial values , e = 0\n");
+			exit(1);
+		}
+		stage_end(opt.prof, PROF_INITIAL, &tm, c);
+	}
+	else
+	{
+		printf("\nThere are no data files to be absorbed\n");
+		exit(1);
+	}
+	/* Comparing the vector kernel with the long double one by calling the function validate_kernel() */
+	if (opt.validate)
+	{
+		diff = validate_kernel(files, t, &in_val[0], &opt);
+		printf("\nValidation of the %s kernel: maximum normalized difference = %.3Le (tolerance %.0e)", simd_name(), diff, SIMDTOL);
+		if (diff > SIMDTOL)
+		{
+			printf("\nThe long double kernel is used");
+			opt.simd = false;
+		}
+	}
+	x = x1;
+	if (rc == 0)
+		printf("\nResumed from the checkpoint %s (%d absorbed files, r = %ld)", opt.checkpoint, k, x1.r);
+	else
+	{
+		/* Iterative adjustment procedure (only for the first group) by calling the function first_solution() */
+		x1 = first_solution(&files[0], &in_val[0], &opt, &iteration, &sigma0ip1);
+		x = x1;
+		names[k] = argv[first];
+		done = 1;
+		/* The first group is kept by the sliding window as linearized at x1 */
+		if (opt.window > 0)
+		{
+			if ((win = malloc(opt.window * sizeof(struct window_group))) == NULL)
+				exit(1);
+			win[0].g.c = c;
+			win[0].g.weight = c;
+			memcpy(win[0].g.N_bar, x1.Nbar, sizeof(x1.Nbar));
+			for (i = 0; i < 9; i++)
+			{
+				win[0].g.U_bar[i] = 0.0L;
+				win[0].xk[i] = x1.x[i];
+			}
+			win[0].g.sum_piwi2 = x1.r * x1.s02;
+			count = 1;
+		}
 	}
 	
-	printf("\nNumber of files = %d\nIncluded files :", t);
-	for (i = 0; i < t; i++)
-		printf("\n%s", argv[i + 1]);
+	/* A checkpoint which has absorbed all the files gives its solution as it is */
+	if (rc == 0 && t == 0)
+		printf("\nThe checkpoint is up to date: no new files to absorb, the solution of its %d files follows", k);
+	else
+	{
+		printf("\nNumber of files = %d\nIncluded files :", t);
+		for (i = 0; i < t; i++)
+			printf("\n%s", argv[first + i]);
+	}
 		
-	x1.s02 = mat.sum_piwi2 / x1.r;
-	/* Printing the first solution that contains the measurements of the group 1 */
-	display(&x1.x[0], 9, 1, 4, "x1");
-	printf("\nc1 = %d\nr1 = %d", c, x1.r);
-	printf("\ns01 = +/- %-.5Lf\nIterations = %d\n", sigma0ip1, iteration);
+	if (rc != 0)
+	{
+		/* Printing the first solution that contains the measurements of the group 1 */
+		display(&x1.x[0], 9, 1, 4, "x1");
+		printf("\nc1 = %ld\nr1 = %ld", c, x1.r);
+		printf("\ns01 = +/- %-.5Lf\nIterations = %d\n", sigma0ip1, iteration);
+		if (opt.checkpoint != NULL && (opt.every == 1 || t == 1) && write_checkpoint(opt.checkpoint, &x, names, k + done) != 0)
+			printf("\nWarning: cant write the checkpoint %s", opt.checkpoint);
+	}
 	
-	/* Sequential adjustments procedure */
-	for (i = 1; i < t; i++)
+	/* Sequential adjustments procedure, with opt.batch groups at once, which are calculated concurrently at the same solution */
+	for (i = done; i < t; i += b)
 	{
-		x = sequential(files[i], x1);
+		b = (t - i < opt.batch) ? t - i : opt.batch;
+		x = sequential(&files[i], b, x1, &opt, added);
 		printf("\n#--------------------------#");
-		printf("\nc%d = %d\nr%d = %d", i + 1, x.r + 9, i + 1, x.r);
-		printf("\ns0_%d = +/- %-.5Lf", i + 1, (type)sqrt(x.s02));
+		if (b > 1)
+			printf("\nGroups %d-%d", k + i + 1, k + i + b);
+		/* Removing the oldest groups of a full window by calling the function downdate() */
+		for (l = 0; opt.window > 0 && l < b; l++)
+		{
+			if (count == opt.window)
+			{
+				x = downdate(x, &win[head].g, &win[head].xk[0]);
+				printf("\nRemoved group %d (%ld points)", i + l + 1 - opt.window, win[head].g.c);
+				head = (head + 1) % opt.window;
+				count--;
+			}
+			win[(head + count) % opt.window].g = added[l];
+			for (j = 0; j < 9; j++)
+				win[(head + count) % opt.window].xk[j] = x1.x[j];
+			count++;
+		}
+		printf("\nc%d = %ld\nr%d = %ld", k + i + b, x.r + 9, k + i + b, x.r);
+		printf("\ns0_%d = +/- %-.5Lf", k + i + b, (type)sqrt(x.s02));
+		for (j = 0; j < 9; j++)
+			dx[j] = x.x[j] - x1.x[j];
+		profile_iteration(opt.prof, k + i + b, 1, sqrt(x.s02), &dx[0]);
 		x1 = x;
+		/* Writing the checkpoint every opt.every groups and after the last group by calling the function write_checkpoint() */
+		for (l = 0; l < b; l++)
+			names[k + i + l] = argv[first + i + l];
+		if (opt.checkpoint != NULL && ((k + i + b) / opt.every > (k + i) / opt.every || i + b == t) && write_checkpoint(opt.checkpoint, &x, names, k + i + b) != 0)
+			printf("\nWarning: cant write the checkpoint %s", opt.checkpoint);
 	}
-	/* Inversion of the matrix N by calling the function cholesky() */
-	cholesky(&x.Nbar[0][0], &N_inv[0][0], 9);
+	/* Inversion of the matrix N by calling the functions ldl_factor() and ldl_inverse() */
+	stage_begin(opt.prof, &tm);
+	ldl_factor(&x.Nbar[0], &f);
+	ldl_inverse(&f, &N_inv[0][0], true);
 	
 	/* Calculating the variance-covariance matrix */
 	for (i = 0; i < 9; i++)
 		for (j = 0; j < 9; j++)
 			Vx[i][j] = x.s02 * N_inv[i][j];
+	stage_end(opt.prof, PROF_COVARIANCE, &tm, 0);
 	/* Closing all the data files */
 	for (i = 0; i < t; i++)
-		fclose(files[i]);
+		close_data(&files[i]);
+	free(arena);
+	if (absorbed != NULL)
+		free(absorbed[0]);
+	free(absorbed);
+	free(names);
+	free(win);
 		
 	/* Calculating each parameter's std */		
 	stx = sqrt(Vx[0][0]);
@@ -128,11 +275,11 @@ int main(int argc, char *argv[])
 	c = x.r + 9;
 	n = 3 * c;
 	m = 9 + 2 * c;
-	printf("\n\nc = %d points", c);
-	printf("\nn = %d measurements", n);
-	printf("\nm = %d unknowns", m);
-	printf("\nr = %d degrees of freedom", x.r);
-	printf("\nExecution time = %ld [s]", clock() / CLOCKS_PER_SEC);
+	printf("\n\nc = %ld points", c);
+	printf("\nn = %ld measurements", n);
+	printf("\nm = %ld unknowns", m);
+	printf("\nr = %ld degrees of freedom", x.r);
+	printf("\nExecution time = %.3f [s] (wall), %.3f [s] (CPU)", clock_seconds(CLOCK_MONOTONIC) - start, clock_seconds(CLOCK_PROCESS_CPUTIME_ID));
 	printf("\n\nElipsoid Parameters:");
 	printf("\ntx = %-.4Lf +/- %-.5Lf [m]", x.x[0], stx);
 	printf("\nty = %-.4Lf +/- %-.5Lf [m]", x.x[1], sty);
@@ -145,6 +292,13 @@ int main(int argc, char *argv[])
 	printf("\ntheta_z = %-.4Lf +/- %-.5Lf [deg]", x.x[8], sthetaz);
 	printf("\ns0_aposteriori = +/- %-.4Lf [m]", (type)sqrt(x.s02));
 	display(&Vx[0][0], 9, 9, 7, "Vx");
+	/* Writing the instrumentation report by calling the function write_profile() */
+	if (opt.prof != NULL)
+	{
+		if (write_profile(opt.profile, &prof, argv[0], &opt) != 0)
+			printf("\nWarning: cant write the report %s", opt.profile);
+		profile_free(&prof);
+	}
 	return 0;	
 }
 
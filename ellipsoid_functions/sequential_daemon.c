@@ -0,0 +1,603 @@
+/**
+ * \file		sequential_daemon.c
+ * \brief       Daemon of the incremental sequential adjustments
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+#define LINE 1024 /* Largest command line of a client */
+#define CLIENTS 64 /* Largest number of connected clients */
+#define DAEMON_MAX_POINTS 16777216L /* Largest number of points of a PUT command (512 MB) */
+
+/* A structure for a batch of points: a data file or points received from a client */
+struct batch {
+	char *path;
+	struct cart_coord *pts;
+	long n;
+	struct batch *next;
+};
+
+/* A structure for the state which is shared by the main thread and the worker: the
+ * queue of the batches and the answer to the queries, which is prepared by the worker
+ * after every batch, so that the queries do not wait for the calculations */
+struct state {
+	pthread_mutex_t lock;
+	pthread_cond_t more;
+	struct batch *head, *tail;
+	int pending;
+	bool stop;
+	struct options *opt;
+	char reply[4096];
+};
+
+/* A structure for a client: its file descriptors, the unfinished command line and the
+ * points of an unfinished PUT command, which are received as they arrive */
+struct client {
+	int in, out;
+	size_t len;
+	char line[LINE];
+	struct cart_coord *pts;
+	long n;
+	size_t size, done;
+};
+
+static volatile sig_atomic_t quit = 0;
+
+/**
+ * \brief           Stops the daemon at SIGINT or SIGTERM
+ * \param[in]       sig: The number of the signal
+ */
+static void stop_signal(int sig)
+{
+	(void)sig;
+	quit = 1;
+}
+
+/**
+ * \brief           Writes a text to a file descriptor
+ * \param[in]       fd: The file descriptor
+ * \param[in]       text: The text
+ */
+static void send_text(int fd, const char *text)
+{
+	size_t done = 0, len = strlen(text);
+	ssize_t got;
+
+	while (done < len && (got = write(fd, text + done, len - done)) > 0)
+		done += got;
+}
+
+/**
+ * \brief           Adds a batch to the end of the queue of the worker
+ * \param[in]       st: The state of the daemon
+ * \param[in]       path: The name of the data file (allocated), or a null pointer
+ * \param[in]       pts: The points (allocated) of a batch without a data file
+ * \param[in]       n: The number of the points
+ */
+static void queue_batch(struct state *st, char *path, struct cart_coord *pts, long n)
+{
+	struct batch *b;
+
+	if ((b = malloc(sizeof(struct batch))) == NULL)
+	{
+		free(path);
+		free(pts);
+		return;
+	}
+	b->path = path;
+	b->pts = pts;
+	b->n = n;
+	b->next = NULL;
+	pthread_mutex_lock(&st->lock);
+	if (st->tail != NULL)
+		st->tail->next = b;
+	else
+		st->head = b;
+	st->tail = b;
+	st->pending++;
+	pthread_cond_signal(&st->more);
+	pthread_mutex_unlock(&st->lock);
+}
+
+/**
+ * \brief           Prepares the answer to the queries: the solution, its standard
+ * 					deviation and the variance-covariance matrix Vx
+ * \param[in]       st: The state of the daemon
+ * \param[in]       x: The current solution, or a null pointer before the first group
+ * \param[in]       groups: The number of the absorbed groups
+ * \param[in]       error: The error of the last batch, or a null pointer
+ */
+static void publish(struct state *st, struct solution *x, long groups, const char *error)
+{
+	register int i, j;
+	int len = 0;
+	type N_inv[9][9];
+	struct ldl f;
+	char text[sizeof(st->reply)];
+
+	len += snprintf(text + len, sizeof(text) - len, "groups %ld\n", groups);
+	if (x != NULL)
+	{
+		/* Calculating the variance-covariance matrix */
+		ldl_factor(&x->Nbar[0], &f);
+		ldl_inverse(&f, &N_inv[0][0], true);
+		len += snprintf(text + len, sizeof(text) - len, "c %ld\nr %ld\ns0 %.10Le\nx", x->r + 9, x->r, (type)sqrt(x->s02));
+		for (i = 0; i < 9; i++)
+			len += snprintf(text + len, sizeof(text) - len, " %.15Le", x->x[i]);
+		for (i = 0; i < 9; i++)
+		{
+			len += snprintf(text + len, sizeof(text) - len, "\nVx");
+			for (j = 0; j < 9; j++)
+				len += snprintf(text + len, sizeof(text) - len, " %.10Le", x->s02 * N_inv[i][j]);
+		}
+		len += snprintf(text + len, sizeof(text) - len, "\n");
+	}
+	if (error != NULL)
+		snprintf(text + len, sizeof(text) - len, "error %s\n", error);
+	pthread_mutex_lock(&st->lock);
+	strcpy(st->reply, text);
+	pthread_mutex_unlock(&st->lock);
+}
+
+/**
+ * \brief           Applies the batches of the queue in order: the first group gives the
+ * 					first solution (function first_solution()) and every next group is
+ * 					added by the function sequential()
+ * \param[in]       arg: A pointer to the state of the daemon
+ * \return			A null pointer
+ */
+static void *worker(void *arg)
+{
+	struct state *st = arg;
+	struct batch *b;
+	struct data_file df;
+	struct solution x;
+	bool have = false;
+	long groups = 0;
+	int iterations;
+	type values[9], sigma0;
+	char error[LINE + 64];
+
+	for (;;)
+	{
+		pthread_mutex_lock(&st->lock);
+		while (st->head == NULL && !st->stop)
+			pthread_cond_wait(&st->more, &st->lock);
+		if ((b = st->head) == NULL)
+		{
+			pthread_mutex_unlock(&st->lock);
+			break;
+		}
+		if ((st->head = b->next) == NULL)
+			st->tail = NULL;
+		pthread_mutex_unlock(&st->lock);
+		error[0] = '\0';
+		if (b->path != NULL && open_data(b->path, &df, st->opt) != 0)
+			snprintf(error, sizeof(error), "cant open the file %s", b->path);
+		else
+		{
+			if (b->path == NULL)
+			{
+				/* The points of the client are used like a parsed text file */
+				memset(&df, 0, sizeof(df));
+				df.name = "(socket)";
+				df.map = b->pts;
+				df.c = b->n;
+				df.parsed = true;
+			}
+			if (have)
+				x = sequential(&df, 1, x, st->opt, NULL);
+			else if (df.c <= 9)
+				snprintf(error, sizeof(error), "the first group needs more than 9 points");
+			else if (initial_values(&df, 1, &values[0], st->opt) < 0)
+				snprintf(error, sizeof(error), "the initial values cannot be calculated");
+			else
+			{
+				x = first_solution(&df, &values[0], st->opt, &iterations, &sigma0);
+				have = true;
+			}
+			if (error[0] == '\0')
+				fprintf(stderr, "group %ld: %s, %ld points, s0 = %.5Lf\n", ++groups, df.name, df.c, (type)sqrt(x.s02));
+			close_data(&df);
+		}
+		if (error[0] != '\0')
+			fprintf(stderr, "error: %s\n", error);
+		publish(st, have ? &x : NULL, groups, error[0] != '\0' ? error : NULL);
+		free(b->path);
+		free(b);
+		pthread_mutex_lock(&st->lock);
+		st->pending--;
+		pthread_mutex_unlock(&st->lock);
+	}
+	return NULL;
+}
+
+/**
+ * \brief           Checks the extension of the name of a data file
+ * \param[in]       name: The name of the file
+ * \return			True for the extensions .bin, .qbin, .cbin and .txt
+ */
+static bool data_name(const char *name)
+{
+	const char *ext = strrchr(name, '.');
+
+	return name[0] != '.' && ext != NULL && (strcmp(ext, ".bin") == 0 || strcmp(ext, ".qbin") == 0
+			|| strcmp(ext, ".cbin") == 0 || strcmp(ext, ".txt") == 0);
+}
+
+/**
+ * \brief           Moves the new data files of the spool directory into its subdirectory
+ * 					done and adds them to the queue, in alphabetical order. The files must
+ * 					be complete when they get their name (e.g. written with another
+ * 					name and renamed)
+ * \param[in]       st: The state of the daemon
+ * \param[in]       dir: The spool directory
+ */
+static void scan_spool(struct state *st, char *dir)
+{
+	register int i;
+	int n = 0, cap = 16;
+	DIR *dp;
+	struct dirent *de;
+	char **names, **grown, *src, *dst;
+
+	if ((dp = opendir(dir)) == NULL || (names = malloc(cap * sizeof(char *))) == NULL)
+	{
+		if (dp != NULL)
+			closedir(dp);
+		return;
+	}
+	names[n++] = NULL;
+	while ((de = readdir(dp)) != NULL)
+		if (data_name(de->d_name))
+		{
+			if (n == cap)
+			{
+				if ((grown = realloc(names, 2 * cap * sizeof(char *))) == NULL)
+					break;
+				names = grown;
+				cap *= 2;
+			}
+			if ((names[n] = strdup(de->d_name)) != NULL)
+				n++;
+		}
+	closedir(dp);
+	alpha_sort(names, n);
+	for (i = 1; i < n; i++)
+	{
+		src = malloc(2 * strlen(dir) + strlen(names[i]) + 8);
+		dst = malloc(strlen(dir) + strlen(names[i]) + 8);
+		if (src != NULL && dst != NULL)
+		{
+			sprintf(src, "%s/%s", dir, names[i]);
+			sprintf(dst, "%s/done/%s", dir, names[i]);
+			if (rename(src, dst) == 0)
+			{
+				queue_batch(st, dst, NULL, 0);
+				dst = NULL;
+			}
+		}
+		free(src);
+		free(dst);
+		free(names[i]);
+	}
+	free(names);
+}
+
+/**
+ * \brief           Adds the received points of a PUT command to the queue
+ * \param[in]       st: The state of the daemon
+ * \param[in,out]   cl: The client, whose points are passed to the queue
+ */
+static void put_done(struct state *st, struct client *cl)
+{
+	queue_batch(st, NULL, cl->pts, cl->n);
+	cl->pts = NULL;
+	send_text(cl->out, "OK queued\n");
+}
+
+/**
+ * \brief           Executes a command of a client:
+ * 					GET: the current solution (the answer ends with the line END)
+ * 					ADD path: adds a data file to the queue
+ * 					PUT n: adds the next n points (structures <cart_coord>, at most
+ * 					DAEMON_MAX_POINTS) to the queue
+ * 					QUIT: closes the connection
+ * 					SHUTDOWN: stops the daemon, after the batches of the queue
+ * \param[in]       st: The state of the daemon
+ * \param[in,out]   cl: The client, whose buffer may contain the points of PUT
+ * \param[in]       cmd: The command line
+ * \return			Zero to continue, one to close the client or two to stop the daemon
+ */
+static int command(struct state *st, struct client *cl, char *cmd)
+{
+	long n;
+	char text[sizeof(st->reply) + 64], *path;
+
+	if (strcmp(cmd, "GET") == 0)
+	{
+		pthread_mutex_lock(&st->lock);
+		snprintf(text, sizeof(text), "OK\npending %d\n%sEND\n", st->pending, st->reply);
+		pthread_mutex_unlock(&st->lock);
+		send_text(cl->out, text);
+	}
+	else if (strncmp(cmd, "ADD ", 4) == 0 && cmd[4] != '\0')
+	{
+		if ((path = strdup(cmd + 4)) == NULL)
+		{
+			send_text(cl->out, "ERR not enough memory\n");
+			return 0;
+		}
+		queue_batch(st, path, NULL, 0);
+		send_text(cl->out, "OK queued\n");
+	}
+	else if (strncmp(cmd, "PUT ", 4) == 0 && (n = strtol(cmd + 4, NULL, 10)) > 0)
+	{
+		/* The points are allocated at once, so a client cannot ask for more than DAEMON_MAX_POINTS */
+		if (n > DAEMON_MAX_POINTS)
+		{
+			send_text(cl->out, "ERR too many points\n");
+			return 1;
+		}
+		cl->n = n;
+		cl->size = n * sizeof(struct cart_coord);
+		if ((cl->pts = malloc(cl->size)) == NULL)
+		{
+			send_text(cl->out, "ERR not enough memory\n");
+			return 1;
+		}
+		/* The points follow the command line: first the rest of the buffer, then
+		 * the input of the next calls of the function serve() */
+		cl->done = (cl->len < cl->size) ? cl->len : cl->size;
+		memcpy(cl->pts, cl->line, cl->done);
+		memmove(cl->line, cl->line + cl->done, cl->len - cl->done);
+		cl->len -= cl->done;
+		if (cl->done == cl->size)
+			put_done(st, cl);
+	}
+	else if (strcmp(cmd, "QUIT") == 0)
+		return 1;
+	else if (strcmp(cmd, "SHUTDOWN") == 0)
+	{
+		send_text(cl->out, "OK\n");
+		return 2;
+	}
+	else if (cmd[0] != '\0')
+		send_text(cl->out, "ERR unknown command\n");
+	return 0;
+}
+
+/**
+ * \brief           Reads the available input of a client and executes its complete
+ * 					command lines. During a PUT command the input is the points, which
+ * 					are received without waiting, so that a slow client does not delay
+ * 					the other clients
+ * \param[in]       st: The state of the daemon
+ * \param[in,out]   cl: The client
+ * \return			Zero to continue, one to close the client or two to stop the daemon
+ */
+static int serve(struct state *st, struct client *cl)
+{
+	int rc = 0;
+	size_t k;
+	ssize_t got;
+	char *eol, cmd[LINE];
+
+	if (cl->pts != NULL)
+	{
+		if ((got = read(cl->in, (char *)cl->pts + cl->done, cl->size - cl->done)) <= 0)
+			return 1;
+		cl->done += got;
+		if (cl->done == cl->size)
+			put_done(st, cl);
+		return 0;
+	}
+	if ((got = read(cl->in, cl->line + cl->len, LINE - cl->len)) <= 0)
+		return 1;
+	cl->len += got;
+	while (rc == 0 && cl->pts == NULL && (eol = memchr(cl->line, '\n', cl->len)) != NULL)
+	{
+		k = eol - cl->line;
+		memcpy(cmd, cl->line, k);
+		cmd[k] = '\0';
+		if (k > 0 && cmd[k - 1] == '\r')
+			cmd[k - 1] = '\0';
+		memmove(cl->line, eol + 1, cl->len - k - 1);
+		cl->len -= k + 1;
+		rc = command(st, cl, cmd);
+	}
+	if (rc == 0 && cl->len == LINE)
+	{
+		send_text(cl->out, "ERR line too long\n");
+		return 1;
+	}
+	return rc;
+}
+
+/**
+ * \brief           Keeps the solution of the sequential adjustments resident and adds new
+ * 					groups of points as they arrive: data files given in the command line,
+ * 					files which appear in a spool directory, and commands (ADD, PUT) of
+ * 					clients of a Unix socket or of the standard input. The queries (GET)
+ * 					are answered from the last prepared answer, while a separate thread
+ * 					applies the batches
+ * \param[in]       argc: The number of arguments that main was called (integer)
+ * \param[in]       argv: The vector of arguments (string) which contains
+ * 					the options and the names of the first data files
+ * \return			Zero on success, or one on failure
+ */
+int main(int argc, char *argv[])
+{
+	register int i;
+	int first, n, rc, listen_fd = -1, nclients = 0, timeout;
+	double last_scan = -1e9, now;
+	char *done_dir;
+	struct options opt;
+	struct state st;
+	struct client *clients[CLIENTS];
+	struct pollfd fds[CLIENTS + 1];
+	struct sockaddr_un addr;
+	struct sigaction sa;
+	struct timespec ts;
+	pthread_t tid;
+
+	if ((first = options(argc, argv, &opt)) < 0)
+	{
+		printf("\nUsage: %s [-j threads] [-m] [-s] [-U socket] [-D spool] [file1 file2 ...]\n", argv[0]);
+		exit(1);
+	}
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = stop_signal;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	signal(SIGPIPE, SIG_IGN);
+	pthread_mutex_init(&st.lock, NULL);
+	pthread_cond_init(&st.more, NULL);
+	st.head = st.tail = NULL;
+	st.pending = 0;
+	st.stop = false;
+	st.opt = &opt;
+	strcpy(st.reply, "groups 0\n");
+	/* Listening to the Unix socket */
+	if (opt.socket != NULL)
+	{
+		memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		if (strlen(opt.socket) >= sizeof(addr.sun_path) || (listen_fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+		{
+			printf("\nCant create the socket %s\n", opt.socket);
+			exit(1);
+		}
+		strcpy(addr.sun_path, opt.socket);
+		unlink(opt.socket);
+		if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_fd, 16) != 0)
+		{
+			printf("\nCant create the socket %s\n", opt.socket);
+			exit(1);
+		}
+	}
+	if (opt.spool != NULL)
+	{
+		if ((done_dir = malloc(strlen(opt.spool) + 8)) == NULL)
+			exit(1);
+		sprintf(done_dir, "%s/done", opt.spool);
+		mkdir(done_dir, 0755);
+		free(done_dir);
+	}
+	if (pthread_create(&tid, NULL, worker, &st) != 0)
+	{
+		printf("\nCant create the worker thread\n");
+		exit(1);
+	}
+	/* The data files of the command line are the first groups */
+	if (argc - first > 0)
+		alpha_sort(&argv[first - 1], argc - first + 1);
+	for (i = first; i < argc; i++)
+		queue_batch(&st, strdup(argv[i]), NULL, 0);
+	/* The standard input is the first client */
+	if ((clients[0] = calloc(1, sizeof(struct client))) != NULL)
+	{
+		clients[0]->in = 0;
+		clients[0]->out = 1;
+		nclients = 1;
+	}
+	while (!quit)
+	{
+		/* Scanning the spool directory */
+		timeout = -1;
+		if (opt.spool != NULL)
+		{
+			clock_gettime(CLOCK_MONOTONIC, &ts);
+			now = ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+			if (now - last_scan >= SPOOL_INTERVAL)
+			{
+				scan_spool(&st, opt.spool);
+				last_scan = now;
+			}
+			timeout = SPOOL_INTERVAL - (int)(now - last_scan);
+		}
+		else if (listen_fd < 0 && nclients == 0)
+			break;
+		n = 0;
+		if (listen_fd >= 0)
+		{
+			fds[n].fd = listen_fd;
+			fds[n++].events = POLLIN;
+		}
+		for (i = 0; i < nclients; i++)
+		{
+			fds[n].fd = clients[i]->in;
+			fds[n++].events = POLLIN;
+		}
+		if (poll(fds, n, timeout) <= 0)
+			continue;
+		n = 0;
+		if (listen_fd >= 0 && (fds[n++].revents & POLLIN))
+		{
+			rc = accept(listen_fd, NULL, NULL);
+			if (rc >= 0 && nclients < CLIENTS && (clients[nclients] = calloc(1, sizeof(struct client))) != NULL)
+			{
+				clients[nclients]->in = clients[nclients]->out = rc;
+				nclients++;
+			}
+			else if (rc >= 0)
+				close(rc);
+		}
+		for (i = nclients - 1; i >= 0; i--)
+		{
+			if (!(fds[n + i].revents & (POLLIN | POLLHUP | POLLERR)))
+				continue;
+			if ((rc = serve(&st, clients[i])) == 2)
+				quit = 1;
+			if (rc != 0)
+			{
+				/* Closing the client (the standard input is not closed) */
+				if (clients[i]->in != 0)
+					close(clients[i]->in);
+				free(clients[i]->pts);
+				free(clients[i]);
+				clients[i] = clients[--nclients];
+			}
+		}
+	}
+	/* Applying the batches of the queue and stopping the worker */
+	pthread_mutex_lock(&st.lock);
+	st.stop = true;
+	pthread_cond_signal(&st.more);
+	pthread_mutex_unlock(&st.lock);
+	pthread_join(tid, NULL);
+	for (i = 0; i < nclients; i++)
+	{
+		if (clients[i]->in != 0)
+			close(clients[i]->in);
+		free(clients[i]->pts);
+		free(clients[i]);
+	}
+	if (listen_fd >= 0)
+	{
+		close(listen_fd);
+		unlink(opt.socket);
+	}
+	printf("%s", st.reply);
+	return 0;
+}
@@ -0,0 +1,203 @@
+/**
+ * \file		simd_kernel.h
+ * \brief       Template of the double precision vector kernel
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+/* This file is included by accumulate_simd.c once for every instruction set, after defining:
+ * KERNEL: the name of the function, VEC: the vector type, LANES: the number of doubles
+ * of the vector and TARGET: the attribute which enables the instruction set */
+
+/**
+ * \brief           Adds the contribution of a span of points to the upper triangular
+ * 					matrix N, the vector u and the sum of the weighted squared misclosures,
+ * 					processing LANES points at once in double precision. The partial sums
+ * 					are moved to the long double structure <group> every BLOCK points.
+ * 					With a robust weight function, the weights of the lanes are multiplied
+ * 					by the factors of their standardized misclosures (function robust_weight())
+ * \param[in]       sp: The span of points (Cartesian coordinates and weights)
+ * \param[in]       md: The coefficients of the linearized model
+ * \param[in,out]   matr: The structure <group> which accumulates the contribution
+ */
+TARGET static void KERNEL(struct span *sp, struct model *md, struct group *matr)
+{
+	register int i, j, l, q;
+	long b, k, e, idx, n = sp->n, s = sp->stride;
+	type sum;
+	double lx[LANES], ly[LANES], lz[LANES], lw[LANES], lm[LANES], le[LANES];
+	VEC x, y, z, w, m, DX, DY, DZ, DX2, DY2, DZ2, DXDY, DXDZ, DYDZ;
+	VEC d[9], wi, p_bari, Fi, Wi, NC, N[45], U[9], sum_piwi2, rho, weight, iscale2;
+	VEC tx, ty, tz, pxx, pyy, pzz, pxy, pxz, pyz;
+	VEC dpxx_dax, dpxx_day, dpxx_daz, dpxx_dthy, dpxx_dthz;
+	VEC dpyy_dax, dpyy_day, dpyy_daz, dpyy_dthy, dpyy_dthz;
+	VEC dpzz_dax, dpzz_day, dpzz_daz, dpzz_dthy, dpzz_dthz;
+	VEC dpxy_dax, dpxy_day, dpxy_daz, dpxy_dthy, dpxy_dthz;
+	VEC dpxz_dax, dpxz_day, dpxz_daz, dpxz_dthy, dpxz_dthz;
+	VEC dpyz_dax, dpyz_day, dpyz_daz, dpyz_dthy, dpyz_dthz;
+	VEC zero = {0.0};
+
+	/* Broadcasting the coefficients of the model to all the lanes */
+	tx = zero + (double)md->tx;
+	ty = zero + (double)md->ty;
+	tz = zero + (double)md->tz;
+	pxx = zero + (double)md->pxx;
+	pyy = zero + (double)md->pyy;
+	pzz = zero + (double)md->pzz;
+	pxy = zero + (double)md->pxy;
+	pxz = zero + (double)md->pxz;
+	pyz = zero + (double)md->pyz;
+	dpxx_dax = zero + (double)md->dpxx_dax;
+	dpyy_dax = zero + (double)md->dpyy_dax;
+	dpzz_dax = zero + (double)md->dpzz_dax;
+	dpxy_dax = zero + (double)md->dpxy_dax;
+	dpxz_dax = zero + (double)md->dpxz_dax;
+	dpyz_dax = zero + (double)md->dpyz_dax;
+	dpxx_day = zero + (double)md->dpxx_day;
+	dpyy_day = zero + (double)md->dpyy_day;
+	dpzz_day = zero + (double)md->dpzz_day;
+	dpxy_day = zero + (double)md->dpxy_day;
+	dpxz_day = zero + (double)md->dpxz_day;
+	dpyz_day = zero + (double)md->dpyz_day;
+	dpxx_daz = zero + (double)md->dpxx_daz;
+	dpyy_daz = zero + (double)md->dpyy_daz;
+	dpzz_daz = zero + (double)md->dpzz_daz;
+	dpxy_daz = zero + (double)md->dpxy_daz;
+	dpxz_daz = zero + (double)md->dpxz_daz;
+	dpyz_daz = zero + (double)md->dpyz_daz;
+	dpxx_dthy = zero + (double)md->dpxx_dthy;
+	dpyy_dthy = zero + (double)md->dpyy_dthy;
+	dpzz_dthy = zero + (double)md->dpzz_dthy;
+	dpxy_dthy = zero + (double)md->dpxy_dthy;
+	dpxz_dthy = zero + (double)md->dpxz_dthy;
+	dpyz_dthy = zero + (double)md->dpyz_dthy;
+	dpxx_dthz = zero + (double)md->dpxx_dthz;
+	dpyy_dthz = zero + (double)md->dpyy_dthz;
+	dpzz_dthz = zero + (double)md->dpzz_dthz;
+	dpxy_dthz = zero + (double)md->dpxy_dthz;
+	dpxz_dthz = zero + (double)md->dpxz_dthz;
+	dpyz_dthz = zero + (double)md->dpyz_dthz;
+	iscale2 = zero + (double)md->iscale2;
+	for (b = 0; b < n; b += BLOCK)
+	{
+		e = (b + BLOCK < n) ? b + BLOCK : n;
+		for (q = 0; q < 45; q++)
+			N[q] = zero;
+		for (i = 0; i < 9; i++)
+			U[i] = zero;
+		sum_piwi2 = weight = zero;
+		for (k = b; k < e; k += LANES)
+		{
+			/* Loading LANES points; the lanes after the end of the block repeat its last point with zero weight */
+			if (s == 1 && k + LANES <= e)
+			{
+				memcpy(&x, &sp->x[k], sizeof(VEC));
+				memcpy(&y, &sp->y[k], sizeof(VEC));
+				memcpy(&z, &sp->z[k], sizeof(VEC));
+				memcpy(&w, &sp->w[k], sizeof(VEC));
+				m = zero + 1.0;
+			}
+			else
+			{
+				for (l = 0; l < LANES; l++)
+				{
+					idx = (k + l < e) ? k + l : e - 1;
+					lx[l] = sp->x[idx * s];
+					ly[l] = sp->y[idx * s];
+					lz[l] = sp->z[idx * s];
+					lw[l] = sp->w[idx * s];
+					lm[l] = (k + l < e) ? 1.0 : 0.0;
+				}
+				memcpy(&x, lx, sizeof(VEC));
+				memcpy(&y, ly, sizeof(VEC));
+				memcpy(&z, lz, sizeof(VEC));
+				memcpy(&w, lw, sizeof(VEC));
+				memcpy(&m, lm, sizeof(VEC));
+			}
+			DX = x - tx;
+			DY = y - ty;
+			DZ = z - tz;
+			DX2 = DX * DX;
+			DY2 = DY * DY;
+			DZ2 = DZ * DZ;
+			DXDY = DX * DY;
+			DXDZ = DX * DZ;
+			DYDZ = DY * DZ;
+			/* Partial derivatives of the function F with respect to tx, ty, tz, ax, ay, az, thetax, thetay and thetaz */
+			d[0] = -2.0 * pxx * DX - 2.0 * pxy * DY - 2.0 * pxz * DZ;
+			d[1] = -2.0 * pxy * DX - 2.0 * pyy * DY - 2.0 * pyz * DZ;
+			d[2] = -2.0 * pxz * DX - 2.0 * pyz * DY - 2.0 * pzz * DZ;
+			d[3] = dpxx_dax * DX2 + dpyy_dax * DY2 + dpzz_dax * DZ2 + 2.0 * dpxy_dax * DXDY + 2.0 * dpxz_dax * DXDZ + 2.0 * dpyz_dax * DYDZ;
+			d[4] = dpxx_day * DX2 + dpyy_day * DY2 + dpzz_day * DZ2 + 2.0 * dpxy_day * DXDY + 2.0 * dpxz_day * DXDZ + 2.0 * dpyz_day * DYDZ;
+			d[5] = dpxx_daz * DX2 + dpyy_daz * DY2 + dpzz_daz * DZ2 + 2.0 * dpxy_daz * DXDY + 2.0 * dpxz_daz * DXDZ + 2.0 * dpyz_daz * DYDZ;
+			d[6] = -2.0 * pyz * DY2 + 2.0 * pyz * DZ2 - 2.0 * pxz * DXDY + 2.0 * pxy * DXDZ + 2.0 * pyy * DYDZ - 2.0 * pzz * DYDZ;
+			d[7] = dpxx_dthy * DX2 + dpyy_dthy * DY2 + dpzz_dthy * DZ2 + 2.0 * dpxy_dthy * DXDY + 2.0 * dpxz_dthy * DXDZ + 2.0 * dpyz_dthy * DYDZ;
+			d[8] = dpxx_dthz * DX2 + dpyy_dthz * DY2 + dpzz_dthz * DZ2 + 2.0 * dpxy_dthz * DXDY + 2.0 * dpxz_dthz * DXDZ + 2.0 * dpyz_dthz * DYDZ;
+			wi = (d[0] * d[0] + d[1] * d[1] + d[2] * d[2]) / w;
+			p_bari = m / wi;
+			/* The function F(tx, ty, tz, ax, ay, az, thetax, thetay, thetaz) */
+			Fi = pxx * DX2 + pyy * DY2 + pzz * DZ2 + 2.0 * pxy * DXDY + 2.0 * pxz * DXDZ + 2.0 * pyz * DYDZ - 1.0;
+			/* Down-weighting the lanes according to their standardized misclosures */
+			if (md->robust != ROBUST_NONE)
+			{
+				rho = Fi * Fi * p_bari * iscale2;
+				memcpy(le, &rho, sizeof(VEC));
+				for (l = 0; l < LANES; l++)
+					le[l] = robust_weight(le[l], md);
+				memcpy(&rho, le, sizeof(VEC));
+				p_bari *= rho;
+				weight += rho * m;
+			}
+			else
+				weight += m;
+			Wi = -Fi * p_bari;
+			sum_piwi2 += Fi * Fi * p_bari;
+			/* Elements of the matrix N (upper triangular, by rows) and of the vector u */
+			for (i = 0, q = 0; i < 9; i++)
+			{
+				NC = d[i] * p_bari;
+				for (j = i; j < 9; j++, q++)
+					N[q] += NC * d[j];
+				U[i] += d[i] * Wi;
+			}
+		}
+		/* Adding the lanes of the partial sums of the block to the structure <group> */
+		for (i = 0, q = 0; i < 9; i++)
+		{
+			for (j = i; j < 9; j++, q++)
+			{
+				for (l = 0, sum = 0.0L; l < LANES; l++)
+					sum += N[q][l];
+				matr->N_bar[q] += sum;
+			}
+			for (l = 0, sum = 0.0L; l < LANES; l++)
+				sum += U[i][l];
+			matr->U_bar[i] += sum;
+		}
+		for (l = 0, sum = 0.0L; l < LANES; l++)
+			sum += sum_piwi2[l];
+		matr->sum_piwi2 += sum;
+		for (l = 0, sum = 0.0L; l < LANES; l++)
+			sum += weight[l];
+		matr->weight += sum;
+	}
+	matr->c += n;
+}
@@ -0,0 +1,197 @@
+/**
+ * \file		simd_packed.h
+ * \brief       Template of the double precision vector kernel of packed fits
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+/* This file is included by accumulate_simd.c once for every instruction set, after defining:
+ * PACKED: the name of the function, VEC: the vector type, LANES: the number of doubles
+ * of the vector and TARGET: the attribute which enables the instruction set */
+
+/* Loading the coefficient f of the model of every lane (the unused lanes repeat lane 0) */
+#define LANE_COEF(v, f) do { \
+		for (l = 0; l < LANES; l++) \
+			tmp[l] = (double)md[l < k ? l : 0].f; \
+		memcpy(&v, tmp, sizeof(VEC)); \
+	} while (0)
+
+/**
+ * \brief           Adds the contribution of up to LANES independent spans of points, each with
+ * 					its own linearized model, to their structures <group>. Every lane of the
+ * 					vectors advances a different fit by one point at a time, so that several
+ * 					small fits share the vector instructions. The partial sums of each lane are
+ * 					moved to the long double structure <group> of its fit every BLOCK points
+ * \param[in]       sp: Vector of the k spans of points (at least one point each)
+ * \param[in]       md: Vector of the k coefficients of the linearized models
+ * \param[in,out]   matr: Vector of the k structures <group> which accumulate the contributions
+ * \param[in]       k: The number of fits (1 to LANES)
+ */
+TARGET static void PACKED(struct span *sp, struct model *md, struct group *matr, int k)
+{
+	register int i, j, l, q;
+	long b, e, kk, idx, n[LANES], last[LANES], st[LANES], nmax = 0;
+	double *px[LANES], *py[LANES], *pz[LANES], *pw[LANES];
+	double tmp[LANES], lx[LANES], ly[LANES], lz[LANES], lw[LANES], lm[LANES];
+	VEC x, y, z, w, m, DX, DY, DZ, DX2, DY2, DZ2, DXDY, DXDZ, DYDZ;
+	VEC d[9], wi, p_bari, Fi, Wi, NC, N[45], U[9], sum_piwi2;
+	VEC tx, ty, tz, pxx, pyy, pzz, pxy, pxz, pyz;
+	VEC dpxx_dax, dpxx_day, dpxx_daz, dpxx_dthy, dpxx_dthz;
+	VEC dpyy_dax, dpyy_day, dpyy_daz, dpyy_dthy, dpyy_dthz;
+	VEC dpzz_dax, dpzz_day, dpzz_daz, dpzz_dthy, dpzz_dthz;
+	VEC dpxy_dax, dpxy_day, dpxy_daz, dpxy_dthy, dpxy_dthz;
+	VEC dpxz_dax, dpxz_day, dpxz_daz, dpxz_dthy, dpxz_dthz;
+	VEC dpyz_dax, dpyz_day, dpyz_daz, dpyz_dthy, dpyz_dthz;
+	VEC zero = {0.0};
+
+	/* The points of every lane (the unused lanes repeat the points of lane 0 with zero weight) */
+	for (l = 0; l < LANES; l++)
+	{
+		q = l < k ? l : 0;
+		n[l] = l < k ? sp[l].n : 0;
+		nmax = n[l] > nmax ? n[l] : nmax;
+		last[l] = sp[q].n - 1;
+		st[l] = sp[q].stride;
+		px[l] = sp[q].x;
+		py[l] = sp[q].y;
+		pz[l] = sp[q].z;
+		pw[l] = sp[q].w;
+	}
+	/* The coefficients of the model of every lane */
+	LANE_COEF(tx, tx);
+	LANE_COEF(ty, ty);
+	LANE_COEF(tz, tz);
+	LANE_COEF(pxx, pxx);
+	LANE_COEF(pyy, pyy);
+	LANE_COEF(pzz, pzz);
+	LANE_COEF(pxy, pxy);
+	LANE_COEF(pxz, pxz);
+	LANE_COEF(pyz, pyz);
+	LANE_COEF(dpxx_dax, dpxx_dax);
+	LANE_COEF(dpyy_dax, dpyy_dax);
+	LANE_COEF(dpzz_dax, dpzz_dax);
+	LANE_COEF(dpxy_dax, dpxy_dax);
+	LANE_COEF(dpxz_dax, dpxz_dax);
+	LANE_COEF(dpyz_dax, dpyz_dax);
+	LANE_COEF(dpxx_day, dpxx_day);
+	LANE_COEF(dpyy_day, dpyy_day);
+	LANE_COEF(dpzz_day, dpzz_day);
+	LANE_COEF(dpxy_day, dpxy_day);
+	LANE_COEF(dpxz_day, dpxz_day);
+	LANE_COEF(dpyz_day, dpyz_day);
+	LANE_COEF(dpxx_daz, dpxx_daz);
+	LANE_COEF(dpyy_daz, dpyy_daz);
+	LANE_COEF(dpzz_daz, dpzz_daz);
+	LANE_COEF(dpxy_daz, dpxy_daz);
+	LANE_COEF(dpxz_daz, dpxz_daz);
+	LANE_COEF(dpyz_daz, dpyz_daz);
+	LANE_COEF(dpxx_dthy, dpxx_dthy);
+	LANE_COEF(dpyy_dthy, dpyy_dthy);
+	LANE_COEF(dpzz_dthy, dpzz_dthy);
+	LANE_COEF(dpxy_dthy, dpxy_dthy);
+	LANE_COEF(dpxz_dthy, dpxz_dthy);
+	LANE_COEF(dpyz_dthy, dpyz_dthy);
+	LANE_COEF(dpxx_dthz, dpxx_dthz);
+	LANE_COEF(dpyy_dthz, dpyy_dthz);
+	LANE_COEF(dpzz_dthz, dpzz_dthz);
+	LANE_COEF(dpxy_dthz, dpxy_dthz);
+	LANE_COEF(dpxz_dthz, dpxz_dthz);
+	LANE_COEF(dpyz_dthz, dpyz_dthz);
+	for (b = 0; b < nmax; b += BLOCK)
+	{
+		e = (b + BLOCK < nmax) ? b + BLOCK : nmax;
+		for (q = 0; q < 45; q++)
+			N[q] = zero;
+		for (i = 0; i < 9; i++)
+			U[i] = zero;
+		sum_piwi2 = zero;
+		for (kk = b; kk < e; kk++)
+		{
+			/* Loading point kk of every lane; the finished lanes repeat their last point with zero weight */
+			for (l = 0; l < LANES; l++)
+			{
+				idx = (kk < last[l] ? kk : last[l]) * st[l];
+				lx[l] = px[l][idx];
+				ly[l] = py[l][idx];
+				lz[l] = pz[l][idx];
+				lw[l] = pw[l][idx];
+				lm[l] = (kk < n[l]) ? 1.0 : 0.0;
+			}
+			memcpy(&x, lx, sizeof(VEC));
+			memcpy(&y, ly, sizeof(VEC));
+			memcpy(&z, lz, sizeof(VEC));
+			memcpy(&w, lw, sizeof(VEC));
+			memcpy(&m, lm, sizeof(VEC));
+			DX = x - tx;
+			DY = y - ty;
+			DZ = z - tz;
+			DX2 = DX * DX;
+			DY2 = DY * DY;
+			DZ2 = DZ * DZ;
+			DXDY = DX * DY;
+			DXDZ = DX * DZ;
+			DYDZ = DY * DZ;
+			/* Partial derivatives of the function F with respect to tx, ty, tz, ax, ay, az, thetax, thetay and thetaz */
+			d[0] = -2.0 * pxx * DX - 2.0 * pxy * DY - 2.0 * pxz * DZ;
+			d[1] = -2.0 * pxy * DX - 2.0 * pyy * DY - 2.0 * pyz * DZ;
+			d[2] = -2.0 * pxz * DX - 2.0 * pyz * DY - 2.0 * pzz * DZ;
+			d[3] = dpxx_dax * DX2 + dpyy_dax * DY2 + dpzz_dax * DZ2 + 2.0 * dpxy_dax * DXDY + 2.0 * dpxz_dax * DXDZ + 2.0 * dpyz_dax * DYDZ;
+			d[4] = dpxx_day * DX2 + dpyy_day * DY2 + dpzz_day * DZ2 + 2.0 * dpxy_day * DXDY + 2.0 * dpxz_day * DXDZ + 2.0 * dpyz_day * DYDZ;
+			d[5] = dpxx_daz * DX2 + dpyy_daz * DY2 + dpzz_daz * DZ2 + 2.0 * dpxy_daz * DXDY + 2.0 * dpxz_daz * DXDZ + 2.0 * dpyz_daz * DYDZ;
+			d[6] = -2.0 * pyz * DY2 + 2.0 * pyz * DZ2 - 2.0 * pxz * DXDY + 2.0 * pxy * DXDZ + 2.0 * pyy * DYDZ - 2.0 * pzz * DYDZ;
+			d[7] = dpxx_dthy * DX2 + dpyy_dthy * DY2 + dpzz_dthy * DZ2 + 2.0 * dpxy_dthy * DXDY + 2.0 * dpxz_dthy * DXDZ + 2.0 * dpyz_dthy * DYDZ;
+			d[8] = dpxx_dthz * DX2 + dpyy_dthz * DY2 + dpzz_dthz * DZ2 + 2.0 * dpxy_dthz * DXDY + 2.0 * dpxz_dthz * DXDZ + 2.0 * dpyz_dthz * DYDZ;
+			wi = (d[0] * d[0] + d[1] * d[1] + d[2] * d[2]) / w;
+			p_bari = m / wi;
+			/* The function F(tx, ty, tz, ax, ay, az, thetax, thetay, thetaz) */
+			Fi = pxx * DX2 + pyy * DY2 + pzz * DZ2 + 2.0 * pxy * DXDY + 2.0 * pxz * DXDZ + 2.0 * pyz * DYDZ - 1.0;
+			Wi = -Fi * p_bari;
+			sum_piwi2 += Fi * Fi * p_bari;
+			/* Elements of the matrix N (upper triangular, by rows) and of the vector u */
+			for (i = 0, q = 0; i < 9; i++)
+			{
+				NC = d[i] * p_bari;
+				for (j = i; j < 9; j++, q++)
+					N[q] += NC * d[j];
+				U[i] += d[i] * Wi;
+			}
+		}
+		/* Moving the partial sums of every lane of the block to the structure <group> of its fit */
+		for (l = 0; l < k; l++)
+		{
+			for (i = 0, q = 0; i < 9; i++)
+			{
+				for (j = i; j < 9; j++, q++)
+					matr[l].N_bar[q] += N[q][l];
+				matr[l].U_bar[i] += U[i][l];
+			}
+			matr[l].sum_piwi2 += sum_piwi2[l];
+		}
+	}
+	/* The packed fits are least-squares fits, so that the weight factors are one */
+	for (l = 0; l < k; l++)
+	{
+		matr[l].c += n[l];
+		matr[l].weight += n[l];
+	}
+}
+
+#undef LANE_COEF
@@ -0,0 +1,160 @@
+/**
+ * \file		stream_points.c
+ * \brief       Double-buffered streaming of the points
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/* A structure for the ring of buffers which is shared by the reader and the consumer */
+struct ring {
+	struct data_file *df;
+	int nfiles;
+	int nbuf;
+	long bsize;
+	struct cart_coord *buf;
+	long *len;
+	int head; /* Next buffer to be consumed */
+	int tail; /* Next buffer to be filled */
+	int filled;
+	bool done;
+	pthread_mutex_t lock;
+	pthread_cond_t changed;
+};
+
+/**
+ * \brief           Reads the data files in order into the free buffers of the ring,
+ * 					waiting while all the buffers are full
+ * \param[in]       arg: A pointer to the structure <ring>
+ * \return			A null pointer
+ */
+static void *reader(void *arg)
+{
+	struct ring *rg = arg;
+	register int i;
+	long first;
+	ssize_t got;
+	size_t done, size;
+	char *dst;
+
+	for (i = 0; i < rg->nfiles; i++)
+		for (first = 0; first < rg->df[i].c; first += rg->bsize)
+		{
+			pthread_mutex_lock(&rg->lock);
+			while (rg->filled == rg->nbuf)
+				pthread_cond_wait(&rg->changed, &rg->lock);
+			pthread_mutex_unlock(&rg->lock);
+			/* Only the reader uses the buffer tail until it is counted as filled */
+			size = ((rg->df[i].c - first < rg->bsize) ? rg->df[i].c - first : rg->bsize) * sizeof(struct cart_coord);
+			dst = (char *)&rg->buf[rg->tail * rg->bsize];
+			for (done = 0; done < size; done += got)
+				if ((got = pread(fileno(rg->df[i].fp), dst + done, size - done, first * sizeof(struct cart_coord) + done)) <= 0)
+					break;
+			__atomic_fetch_add(&rg->df[i].bytes, done, __ATOMIC_RELAXED);
+			pthread_mutex_lock(&rg->lock);
+			rg->len[rg->tail] = done / sizeof(struct cart_coord);
+			rg->tail = (rg->tail + 1) % rg->nbuf;
+			rg->filled++;
+			pthread_cond_broadcast(&rg->changed);
+			pthread_mutex_unlock(&rg->lock);
+		}
+	pthread_mutex_lock(&rg->lock);
+	rg->done = true;
+	pthread_cond_broadcast(&rg->changed);
+	pthread_mutex_unlock(&rg->lock);
+	return NULL;
+}
+
+/**
+ * \brief           Passes all the points of the data files, in blocks, to a consumer
+ * 					function, while a separate reader thread reads the next blocks into
+ * 					a ring of nbuf buffers. The memory is bounded by the buffers and the
+ * 					reading of block k + 1 overlaps the processing of block k. If the buffers
+ * 					or the thread cannot be created, the points are read and processed in turn
+ * \param[in]       df: Vector of the structures <data_file> of the data files
+ * \param[in]       nfiles: Number of the data files
+ * \param[in]       nbuf: The number of buffers (at least two)
+ * \param[in]       bsize: The number of points of each buffer
+ * \param[in]       consume: The function which processes a span of points
+ * \param[in]       ctx: The argument of the consumer function
+ */
+void stream_points(struct data_file *df, int nfiles, int nbuf, long bsize, void (*consume)(struct span *, void *), void *ctx)
+{
+	register int i;
+	long k, n;
+	struct ring rg;
+	struct span sp;
+	struct cart_coord *pp, buf[BLOCK];
+	pthread_t tid;
+
+	rg.df = df;
+	rg.nfiles = nfiles;
+	rg.nbuf = nbuf;
+	rg.bsize = bsize;
+	rg.head = rg.tail = rg.filled = 0;
+	rg.done = false;
+	rg.buf = malloc(nbuf * bsize * sizeof(struct cart_coord));
+	rg.len = malloc(nbuf * sizeof(long));
+	pthread_mutex_init(&rg.lock, NULL);
+	pthread_cond_init(&rg.changed, NULL);
+	if (rg.buf == NULL || rg.len == NULL || pthread_create(&tid, NULL, reader, &rg) != 0)
+	{
+		/* Without buffers or reader thread the points are read and processed in turn */
+		for (i = 0; i < nfiles; i++)
+			for (k = 0; (n = fetch_points(&df[i], k, df[i].c - k, buf, &sp)) > 0; k += n)
+				consume(&sp, ctx);
+		nbuf = 0;
+	}
+	sp.stride = sizeof(struct cart_coord) / sizeof(double);
+	while (nbuf > 0)
+	{
+		pthread_mutex_lock(&rg.lock);
+		while (rg.filled == 0 && !rg.done)
+			pthread_cond_wait(&rg.changed, &rg.lock);
+		if (rg.filled == 0)
+		{
+			pthread_mutex_unlock(&rg.lock);
+			break;
+		}
+		pthread_mutex_unlock(&rg.lock);
+		/* Processing the buffer head, which is not used by the reader until it is released */
+		pp = &rg.buf[rg.head * bsize];
+		sp.x = &pp->x;
+		sp.y = &pp->y;
+		sp.z = &pp->z;
+		sp.w = &pp->w;
+		sp.n = rg.len[rg.head];
+		if (sp.n > 0)
+			consume(&sp, ctx);
+		pthread_mutex_lock(&rg.lock);
+		rg.head = (rg.head + 1) % nbuf;
+		rg.filled--;
+		pthread_cond_broadcast(&rg.changed);
+		pthread_mutex_unlock(&rg.lock);
+	}
+	if (nbuf > 0)
+		pthread_join(tid, NULL);
+	pthread_cond_destroy(&rg.changed);
+	pthread_mutex_destroy(&rg.lock);
+	free(rg.buf);
+	free(rg.len);
+}
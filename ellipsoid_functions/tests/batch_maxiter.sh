@@ -0,0 +1,21 @@
+#!/bin/sh
+# batch_fit marks an object that reaches the maximum number of iterations (-I) before
+# convergence as maxiter, not as ok, and does not count it as fitted
+dir=$(mktemp -d) || exit 1
+trap 'rm -rf "$dir"' EXIT
+./generate_points "$dir/o" 3000 1 11.25,21.5,28.8,9,3.2,2,41.9,32.1,7.3 0.05 > /dev/null || exit 1
+echo "obj $dir/o01.bin" > "$dir/manifest"
+./batch_fit "$dir/manifest" "$dir/ok.csv" > "$dir/ok.txt" || exit 1
+./batch_fit -I 1 "$dir/manifest" "$dir/max.csv" > "$dir/max.txt" || exit 1
+status=$(sed -n 2p "$dir/ok.csv" | cut -d, -f2)
+if [ "$status" != ok ] || ! grep -q "(1 fitted, 0 not converged, 0 failed)" "$dir/ok.txt"
+then
+	echo "batch_maxiter: status $status without -I"
+	exit 1
+fi
+status=$(sed -n 2p "$dir/max.csv" | cut -d, -f2)
+if [ "$status" != maxiter ] || ! grep -q "(0 fitted, 1 not converged, 0 failed)" "$dir/max.txt"
+then
+	echo "batch_maxiter: status $status with -I 1"
+	exit 1
+fi
@@ -0,0 +1,21 @@
+#!/bin/sh
+# Resuming sequential_adjustments from a checkpoint which has absorbed all the files reports
+# that the checkpoint is up to date and gives its solution, not an empty run
+dir=$(mktemp -d) || exit 1
+trap 'rm -rf "$dir"' EXIT
+./generate_points "$dir/g" 20000 3 11.25,21.5,28.8,9,3.2,2,41.9,32.1,7.3 0.05 > /dev/null || exit 1
+./sequential_adjustments -C "$dir/ck.bin" "$dir"/g0*.bin > "$dir/first.txt" || exit 1
+./sequential_adjustments -R -C "$dir/ck.bin" "$dir"/g0*.bin > "$dir/resumed.txt" || exit 1
+if ! grep -q "checkpoint is up to date.* its 3 files" "$dir/resumed.txt" || grep -q "Number of files = 0" "$dir/resumed.txt"
+then
+	echo "checkpoint_up_to_date:"
+	head -n 4 "$dir/resumed.txt"
+	exit 1
+fi
+awk '$2 == "=" && $4 == "+/-" { print $1, $3, $5 }' "$dir/first.txt" > "$dir/first.par"
+awk '$2 == "=" && $4 == "+/-" { print $1, $3, $5 }' "$dir/resumed.txt" > "$dir/resumed.par"
+if [ "$(wc -l < "$dir/first.par")" -ne 9 ] || ! cmp -s "$dir/first.par" "$dir/resumed.par"
+then
+	echo "checkpoint_up_to_date: the restored solution differs"
+	exit 1
+fi
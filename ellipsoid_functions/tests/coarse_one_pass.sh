@@ -0,0 +1,24 @@
+#!/bin/sh
+# After the coarse iterations (-F) one pass over all the points converges to the solution of
+# the full fit, while the fit without -F keeps its two passes
+dir=$(mktemp -d) || exit 1
+trap 'rm -rf "$dir"' EXIT
+./generate_points "$dir/c" 200000 4 11.25,21.5,28.8,9,3.2,2,41.9,32.1,7.3 0.05 > /dev/null || exit 1
+./separation_in_groups "$dir"/c0*.bin > "$dir/full.txt" || exit 1
+./separation_in_groups -F 0.01 "$dir"/c0*.bin > "$dir/coarse.txt" || exit 1
+full=$(grep "^Iterations =" "$dir/full.txt" | cut -d' ' -f3)
+coarse=$(grep "^Iterations =" "$dir/coarse.txt" | cut -d' ' -f3)
+if [ "$full" != 2 ] || [ "$coarse" != 1 ]
+then
+	echo "coarse_one_pass: $full full passes without -F, $coarse with -F 0.01"
+	exit 1
+fi
+# The same parameters, to the printed digits
+awk '$2 == "=" && $4 == "+/-" { print $1, $3 }' "$dir/full.txt" > "$dir/full.par"
+awk '$2 == "=" && $4 == "+/-" { print $1, $3 }' "$dir/coarse.txt" > "$dir/coarse.par"
+if [ "$(wc -l < "$dir/full.par")" -ne 9 ] || ! cmp -s "$dir/full.par" "$dir/coarse.par"
+then
+	echo "coarse_one_pass: the parameters differ"
+	diff "$dir/full.par" "$dir/coarse.par"
+	exit 1
+fi
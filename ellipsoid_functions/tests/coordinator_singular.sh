@@ -0,0 +1,16 @@
+#!/bin/sh
+# group_coordinator stops with an error when the normal matrix is not positive definite
+# (points of an exact sphere, whose rotation is undetermined), instead of printing NaN
+dir=$(mktemp -d) || exit 1
+trap 'rm -rf "$dir"' EXIT
+./generate_points "$dir/s" 2000 2 1,2,3,5,5,5,0,0,0 0 > /dev/null || exit 1
+./group_worker -U "$dir/gc.sock" 0 "$dir"/s0*.bin > /dev/null &
+./group_coordinator -U "$dir/gc.sock" 1 > "$dir/co.txt"
+rc=$?
+wait
+if [ $rc -eq 0 ] || ! grep -q "not positive definite" "$dir/co.txt"
+then
+	echo "coordinator_singular: exit status $rc"
+	tail -n 3 "$dir/co.txt"
+	exit 1
+fi
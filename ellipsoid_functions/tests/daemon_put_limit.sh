@@ -0,0 +1,7 @@
+#!/bin/sh
+# sequential_daemon rejects a PUT of more than DAEMON_MAX_POINTS points before allocating them
+out=$(printf 'PUT 16777217\n' | ./sequential_daemon) || exit 1
+case "$out" in
+	*"ERR too many points"*) ;;
+	*) echo "daemon_put_limit: $out"; exit 1 ;;
+esac
@@ -0,0 +1,19 @@
+#!/bin/sh
+# fit_bench -r tukey iterates the separation in groups as separation_in_groups -r tukey:
+# the same number of iterations and the same parameters (data with 5% of outliers)
+dir=$(mktemp -d) || exit 1
+trap 'rm -rf "$dir"' EXIT
+./generate_points "$dir/t" 20000 2 11.25,21.5,28.8,9,3.2,2,41.9,32.1,7.3 0.05 1:1 0.05 7 > /dev/null || exit 1
+./separation_in_groups -r tukey "$dir"/t0*.bin > "$dir/sep.txt" || exit 1
+./fit_bench -r tukey "$dir/t.truth" "$dir"/t0*.bin > "$dir/bench.txt" || exit 1
+awk '
+	FNR == NR && /^Iterations =/ { it = $3 }
+	FNR == NR && NF == 6 && $2 == "=" && $4 == "+/-" { x[$1] = $3 }
+	FNR != NR && /^Separation in groups:/ { sep = 1; bit = $NF }
+	FNR != NR && /^Sequential adjustments:/ { sep = 0 }
+	FNR != NR && sep && ($1 in x) { n++; d = $3 - x[$1]; if (d < -0.00006 || d > 0.00006) { print "fit_bench_robust: " $1 " = " $3 ", separation_in_groups " x[$1]; bad = 1 } }
+	END {
+		if (it == "" || it != bit) { print "fit_bench_robust: " bit " iterations, separation_in_groups " it; bad = 1 }
+		if (n != 9) { print "fit_bench_robust: " n " parameters"; bad = 1 }
+		exit bad
+	}' "$dir/sep.txt" "$dir/bench.txt"
@@ -0,0 +1,85 @@
+/**
+ * \file		txt2bin.c
+ * \brief       Conversion of text files of points into binary files
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Converts a text file of points (x y z w, separated by blanks) into a
+ * 					binary file of structures <cart_coord>, which can be used by the
+ * 					programs separation_in_groups and sequential_adjustments, and the
+ * 					index file of the binary file (moment sums of the initial values)
+ * \param[in]       argc: The number of arguments that main was called (integer)
+ * \param[in]       argv: The vector of arguments (string) which contains
+ * 					the options, the name of the text file and the name of the binary file
+ * \return			Zero on success, or one on failure
+ */
+int main(int argc, char *argv[])
+{
+	int first;
+	long n, bad;
+	double seconds, mbytes;
+	struct timespec t0, t1;
+	struct stat st;
+	struct cart_coord *pts;
+	struct data_file mem;
+	struct point_index idx;
+	struct options opt;
+	FILE *out;
+
+	if ((first = options(argc, argv, &opt)) < 0 || argc - first != 2)
+	{
+		printf("\nUsage: %s [-j threads] input.txt output.bin\n", argv[0]);
+		exit(1);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	if ((n = load_text(argv[first], opt.threads, &pts, &bad)) < 0)
+	{
+		printf("\nCant read the file %s\n", argv[first]);
+		exit(1);
+	}
+	if ((out = fopen(argv[first + 1], "wb")) == NULL || fwrite(pts, sizeof(struct cart_coord), n, out) != (size_t)n || fclose(out) != 0)
+	{
+		printf("\nCant write the file %s\n", argv[first + 1]);
+		exit(1);
+	}
+	/* Calculating the index from the points in memory */
+	memset(&mem, 0, sizeof(mem));
+	mem.map = pts;
+	mem.c = n;
+	index_data(&mem, &idx);
+	if (write_index(argv[first + 1], &idx) != 0)
+		printf("\nWarning: cant write the index file of %s", argv[first + 1]);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	free(pts);
+	seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+	mbytes = (stat(argv[first], &st) == 0) ? st.st_size / 1048576.0 : 0.0;
+	printf("\n%s -> %s", argv[first], argv[first + 1]);
+	printf("\nPoints = %ld", n);
+	if (bad > 0)
+		printf("\nInvalid lines = %ld (not converted)", bad);
+	printf("\nThreads = %d", opt.threads);
+	printf("\nTime = %.3f [s] (%.1f MB/s)\n", seconds, seconds > 0.0 ? mbytes / seconds : 0.0);
+	return 0;
+}
@@ -0,0 +1,91 @@
+/**
+ * \file		unpack_block.c
+ * \brief       Decompression of a block of points
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Decompresses a block of a compressed file (function pack_block())
+ * 					directly into points, which are used by the accumulation kernels
+ * \param[in]       blk: The compressed block
+ * \param[in]       size: The size of the compressed block (bytes)
+ * \param[in]       n: The number of points of the block
+ * \param[in]       qh: The header of the quantized format
+ * \param[out]      pts: The points
+ */
+void unpack_block(const unsigned char *blk, size_t size, long n, struct quant_header *qh, struct cart_coord *pts)
+{
+	register int i;
+	long k;
+	int X, width, s = sizeof(struct cart_coord) / sizeof(double);
+	long long v;
+	unsigned long long acc, mask, zz, bit;
+	size_t at;
+	float w;
+	const unsigned char *p = blk, *end = blk + size;
+	double *dst, scale, offset;
+
+	for (i = 0; i < 3; i++)
+	{
+		dst = (i == 0) ? &pts[0].x : (i == 1) ? &pts[0].y : &pts[0].z;
+		scale = qh->scale[i];
+		offset = qh->offset[i];
+		width = (p < end && *p <= 33) ? *p : 0;
+		p++;
+		mask = (width == 0) ? 0 : ~0ULL >> (64 - width);
+		X = 0;
+		if (p + sizeof(int) <= end)
+			memcpy(&X, p, sizeof(int));
+		p += sizeof(int);
+		v = X;
+		dst[0] = offset + scale * v;
+		/* Unpacking the differences (8 bytes are loaded for every value, since the
+		 * width is at most 33 bits) and adding them to the previous value */
+		for (k = 1, bit = 0; k < n; k++, bit += width)
+		{
+			at = bit >> 3;
+			acc = 0;
+			if (p + at + sizeof(acc) <= end)
+				memcpy(&acc, p + at, sizeof(acc));
+			else if (p + at < end)
+				memcpy(&acc, p + at, end - (p + at));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+			acc = __builtin_bswap64(acc);
+#endif
+			zz = (acc >> (bit & 7)) & mask;
+			v += (long long)(zz >> 1) ^ -(long long)(zz & 1);
+			dst[k * s] = offset + scale * v;
+		}
+		p += (bit + 7) >> 3;
+	}
+	for (k = 0; k < n; k++)
+		if (qh->record > 12 && p + sizeof(float) <= end)
+		{
+			memcpy(&w, p, sizeof(float));
+			p += sizeof(float);
+			pts[k].w = w;
+		}
+		else
+			pts[k].w = qh->weight;
+}
@@ -0,0 +1,72 @@
+/**
+ * \file		validate_kernel.c
+ * \brief       Validation of the vector kernel
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Compares the structures <group> of the double precision vector kernel
+ * 					with those of the long double kernel for all the data files. The
+ * 					differences are normalized by the bounds of the elements, i.e.
+ * 					sqrt(Nii * Njj) for Nij, sqrt(Nii * sum_piwi2) for ui and sum_piwi2
+ * 					for itself, so that they are comparable to the relative precision
+ * \param[in]       df: Vector of the structures <data_file> of the data files
+ * \param[in]       t: Number of the data files
+ * \param[in]       values: Vector of the current values of the triaxial ellipsoid
+ * \param[in]       opt: The run-time options
+ * \return			The maximum normalized difference
+ */
+type validate_kernel(struct data_file *df, int t, type *values, struct options *opt)
+{
+	register int i, j, k;
+	type diff = 0.0L, e;
+	struct options ld = *opt, vec = *opt;
+	struct group a, b;
+
+	ld.simd = false;
+	vec.simd = true;
+	for (k = 0; k < t; k++)
+	{
+		a = direct_calculation(&df[k], values, &ld);
+		b = direct_calculation(&df[k], values, &vec);
+		if (a.c == 0 || a.sum_piwi2 <= 0.0L)
+			continue;
+		for (i = 0; i < 9; i++)
+		{
+			for (j = 0; j < 9; j++)
+			{
+				e = MYABS(b.N_bar[UPPER(i, j)] - a.N_bar[UPPER(i, j)]) / sqrtl(a.N_bar[UPPER(i, i)] * a.N_bar[UPPER(j, j)]);
+				if (e > diff)
+					diff = e;
+			}
+			e = MYABS(b.U_bar[i] - a.U_bar[i]) / sqrtl(a.N_bar[UPPER(i, i)] * a.sum_piwi2);
+			if (e > diff)
+				diff = e;
+		}
+		e = MYABS(b.sum_piwi2 - a.sum_piwi2) / a.sum_piwi2;
+		if (e > diff)
+			diff = e;
+	}
+	return diff;
+}
@@ -0,0 +1,92 @@
+/**
+ * \file		write_checkpoint.c
+ * \brief       Writing of the checkpoint of the sequential adjustments
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Writes the state of the sequential adjustments (the solution and the
+ * 					names of the absorbed data files) into a checkpoint file. The long
+ * 					double values are stored as pairs of doubles (hi, lo), the matrix N as
+ * 					its upper triangle, and a CRC-32 checksum follows the data. The file is
+ * 					written with a temporary name and renamed, so that a checkpoint is
+ * 					never left incomplete
+ * \param[in]       path: The name of the checkpoint file
+ * \param[in]       x: The solution
+ * \param[in]       names: The names of the absorbed data files
+ * \param[in]       n: The number of the absorbed data files
+ * \return			Zero on success, or -1 if the file cannot be written
+ */
+int write_checkpoint(char *path, struct solution *x, char **names, int n)
+{
+	register int i, q;
+	unsigned int crc;
+	char tmp[strlen(path) + 5];
+	struct checkpoint_header hd;
+	FILE *fp;
+
+	memset(&hd, 0, sizeof(hd));
+	memcpy(hd.magic, CKPT_MAGIC, sizeof(hd.magic));
+	hd.version = CKPT_VERSION;
+	hd.files = n;
+	for (i = 0; i < n; i++)
+		hd.names += strlen(names[i]) + 1;
+	hd.r = x->r;
+	for (i = 0; i < 9; i++)
+	{
+		hd.x[i][0] = x->x[i];
+		hd.x[i][1] = x->x[i] - hd.x[i][0];
+	}
+	/* The matrix N is kept packed, so that it is stored as it is */
+	for (q = 0; q < NPACK; q++)
+	{
+		hd.Nbar[q][0] = x->Nbar[q];
+		hd.Nbar[q][1] = x->Nbar[q] - hd.Nbar[q][0];
+	}
+	hd.s02[0] = x->s02;
+	hd.s02[1] = x->s02 - hd.s02[0];
+	sprintf(tmp, "%s.tmp", path);
+	if ((fp = fopen(tmp, "wb")) == NULL)
+		return -1;
+	crc = crc32_update(0, &hd, sizeof(hd));
+	fwrite(&hd, sizeof(hd), 1, fp);
+	for (i = 0; i < n; i++)
+	{
+		crc = crc32_update(crc, names[i], strlen(names[i]) + 1);
+		fwrite(names[i], 1, strlen(names[i]) + 1, fp);
+	}
+	fwrite(&crc, sizeof(crc), 1, fp);
+	if (ferror(fp) || fflush(fp) != 0 || fsync(fileno(fp)) != 0)
+	{
+		fclose(fp);
+		remove(tmp);
+		return -1;
+	}
+	if (fclose(fp) != 0 || rename(tmp, path) != 0)
+	{
+		remove(tmp);
+		return -1;
+	}
+	return 0;
+}
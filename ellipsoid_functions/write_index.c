@@ -0,0 +1,55 @@
+/**
+ * \file		write_index.c
+ * \brief       Writing of the index file of a data file
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/**
+ * \brief           Writes the index of a data file into the file name.idx. The size and
+ * 					the modification time of the data file are stored in the index, so
+ * 					that an index which is older than its data file is not used
+ * \param[in]       name: The name of the data file
+ * \param[in,out]   idx: The structure <point_index> of the file
+ * \return			Zero on success, or -1 if the index file cannot be written
+ */
+int write_index(char *name, struct point_index *idx)
+{
+	struct stat st;
+	char path[strlen(name) + 5];
+	FILE *fp;
+
+	if (stat(name, &st) != 0)
+		return -1;
+	idx->size = st.st_size;
+	idx->mtime = st.st_mtime;
+	sprintf(path, "%s.idx", name);
+	if ((fp = fopen(path, "wb")) == NULL)
+		return -1;
+	if (fwrite(idx, sizeof(struct point_index), 1, fp) != 1)
+	{
+		fclose(fp);
+		return -1;
+	}
+	return (fclose(fp) == 0) ? 0 : -1;
+}
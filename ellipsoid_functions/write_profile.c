@@ -0,0 +1,136 @@
+/**
+ * \file		write_profile.c
+ * \brief       Writing of the instrumentation report (JSON)
+ */
+
+/**
+ *
+ * Copyright (c) 2024, Jason Koci
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHA
+ * NTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General 
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * Author:	Jason Koci <iasonaskotsis@hotmail.com>
+ */
+
+#include "ellipsoid_functions.h"
+
+/* The names of the stages of the instrumentation in the report */
+static const char *stage_names[PROF_STAGES] = {"open", "initial_values", "direct_calculation", "summary", "solve", "covariance"};
+
+/**
+ * \brief           Writes a number, or null if it is not finite (JSON has no NaN)
+ * \param[in]       fp: The report
+ * \param[in]       value: The number
+ */
+static void number(FILE *fp, double value)
+{
+	if (isfinite(value))
+		fprintf(fp, "%.9g", value);
+	else
+		fprintf(fp, "null");
+}
+
+/**
+ * \brief           Writes a string, escaping the quotes, the backslashes and the control characters
+ * \param[in]       fp: The report
+ * \param[in]       s: The string
+ */
+static void string(FILE *fp, const char *s)
+{
+	fputc('"', fp);
+	for (; *s != '\0'; s++)
+		if (*s == '"' || *s == '\\')
+			fprintf(fp, "\\%c", *s);
+		else if ((unsigned char)*s < 0x20)
+			fprintf(fp, "\\u%04x", *s);
+		else
+			fputc(*s, fp);
+	fputc('"', fp);
+}
+
+/**
+ * \brief           Writes the instrumentation report of a run as a JSON object: the options,
+ * 					the total numbers of points and bytes read, the wall and processor times,
+ * 					and for every stage its calls, times, throughput and hardware counters
+ * 					(null without counters), followed by the iterations of the adjustment.
+ * 					The bytes are the bytes read from the data files, so that mapped and
+ * 					cached points are not counted in the stages which use them
+ * \param[in]       name: The name of the report
+ * \param[in]       prof: The structure <profile> of the run
+ * \param[in]       program: The name of the program
+ * \param[in]       opt: The run-time options
+ * \return			Zero on success, or -1 if the report cannot be written
+ */
+int write_profile(char *name, struct profile *prof, char *program, struct options *opt)
+{
+	register int i;
+	struct stage_stats *st;
+	long long points = 0, bytes = 0;
+	double wall, cpu;
+	bool perf = prof->fd[0] >= 0;
+	FILE *fp;
+
+	wall = clock_seconds(CLOCK_MONOTONIC) - prof->wall;
+	cpu = clock_seconds(CLOCK_PROCESS_CPUTIME_ID) - prof->cpu;
+	for (i = 0; i < prof->nfiles; i++)
+	{
+		points += prof->files[i].c;
+		bytes += prof->files[i].bytes;
+	}
+	if ((fp = fopen(name, "w")) == NULL)
+		return -1;
+	fprintf(fp, "{\n\t\"program\": ");
+	string(fp, program);
+	fprintf(fp, ",\n\t\"threads\": %d,\n\t\"io\": \"%s\",\n\t\"cache_mb\": %ld,\n\t\"stream\": %d,\n\t\"kernel\": ",
+			opt->threads, opt->io == IO_MMAP ? "mmap" : "stdio", opt->cache, opt->stream);
+	string(fp, opt->simd ? simd_name() : "long double");
+	fprintf(fp, ",\n\t\"files\": %d,\n\t\"points\": %lld,\n\t\"bytes_read\": %lld,\n\t\"wall\": ", prof->nfiles, points, bytes);
+	number(fp, wall);
+	fprintf(fp, ",\n\t\"cpu\": ");
+	number(fp, cpu);
+	fprintf(fp, ",\n\t\"hardware_counters\": %s,\n\t\"stages\": [", perf ? "true" : "false");
+	for (i = 0; i < PROF_STAGES; i++)
+	{
+		st = &prof->stage[i];
+		fprintf(fp, "%s\n\t\t{\"name\": \"%s\", \"calls\": %ld, \"wall\": ", i > 0 ? "," : "", stage_names[i], st->calls);
+		number(fp, st->wall);
+		fprintf(fp, ", \"cpu\": ");
+		number(fp, st->cpu);
+		fprintf(fp, ", \"points\": %lld, \"bytes\": %lld, \"points_per_s\": ", st->points, st->bytes);
+		number(fp, st->wall > 0.0 ? st->points / st->wall : 0.0);
+		fprintf(fp, ", \"mb_per_s\": ");
+		number(fp, st->wall > 0.0 ? st->bytes / st->wall / 1048576.0 : 0.0);
+		if (perf)
+		{
+			fprintf(fp, ", \"cycles\": %lld, \"instructions\": %lld, \"ipc\": ", st->cycles, st->instructions);
+			number(fp, st->cycles > 0 ? (double)st->instructions / st->cycles : 0.0);
+		}
+		else
+			fprintf(fp, ", \"cycles\": null, \"instructions\": null, \"ipc\": null");
+		fprintf(fp, "}");
+	}
+	fprintf(fp, "\n\t],\n\t\"iterations\": [");
+	for (i = 0; i < prof->count; i++)
+	{
+		fprintf(fp, "%s\n\t\t{\"group\": %d, \"iteration\": %d, \"sigma0\": ", i > 0 ? "," : "", prof->iter[i].group, prof->iter[i].iteration);
+		number(fp, prof->iter[i].sigma0);
+		fprintf(fp, ", \"step_norm\": ");
+		number(fp, prof->iter[i].step);
+		fprintf(fp, ", \"time\": ");
+		number(fp, prof->iter[i].time);
+		fprintf(fp, "}");
+	}
+	fprintf(fp, "\n\t]\n}\n");
+	return (fclose(fp) == 0) ? 0 : -1;
+}